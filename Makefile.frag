@@ -0,0 +1,12 @@
+EXTCSS3_TEST_SOURCES = $(wildcard $(srcdir)/extcss3/*.c $(srcdir)/extcss3/*/*.c $(srcdir)/extcss3/*/*/*.c)
+
+test: extcss3-test-chunked
+
+extcss3-test-chunked: $(builddir)/tests/chunked_tokenizer
+	$(builddir)/tests/chunked_tokenizer
+
+$(builddir)/tests/chunked_tokenizer: $(srcdir)/tests/chunked_tokenizer.c $(EXTCSS3_TEST_SOURCES)
+	@mkdir -p $(builddir)/tests
+	$(CC) -std=gnu99 -Wall $(CFLAGS_CLEAN) -I$(srcdir)/extcss3 -o $@ $(srcdir)/tests/chunked_tokenizer.c $(EXTCSS3_TEST_SOURCES) -lm
+
+.PHONY: extcss3-test-chunked
@@ -5,7 +5,11 @@ PHP_ARG_WITH(extcss3, whether to enable the extcss3 extension,
 if test "$PHP_EXTCSS3" != "no"; then
 	PHP_SUBST(EXTCSS3_SHARED_LIBADD)
 	PHP_NEW_EXTENSION(extcss3,
+		extcss3/allocator.c					\
+		extcss3/arena.c						\
 		extcss3/intern.c					\
+		extcss3/keywords.c					\
+		extcss3/number.c					\
 		extcss3/utils.c						\
 		extcss3/dumper/dumper.c				\
 		extcss3/minifier/minifier.c			\
@@ -14,8 +18,10 @@ if test "$PHP_EXTCSS3" != "no"; then
 		extcss3/minifier/types/hash.c		\
 		extcss3/minifier/types/function.c	\
 		extcss3/tokenizer/preprocessor.c	\
+		extcss3/tokenizer/scanner.c			\
 		extcss3/tokenizer/context.c			\
 		extcss3/tokenizer/tokenizer.c		\
 		php_extcss3.c,
 	$ext_shared, , "-Wall")
+	PHP_ADD_MAKEFILE_FRAGMENT
 fi
@@ -0,0 +1,49 @@
+#include "allocator.h"
+
+#include <string.h>
+
+/* ==================================================================================================== */
+
+static void *_extcss3_libc_malloc(void *data, size_t size)
+{
+	(void)data;
+
+	return malloc(size);
+}
+
+static void *_extcss3_libc_realloc(void *data, void *ptr, size_t size)
+{
+	(void)data;
+
+	return realloc(ptr, size);
+}
+
+static void _extcss3_libc_free(void *data, void *ptr)
+{
+	(void)data;
+
+	free(ptr);
+}
+
+const extcss3_allocator extcss3_default_allocator = {
+	_extcss3_libc_malloc,
+	_extcss3_libc_realloc,
+	_extcss3_libc_free,
+	NULL
+};
+
+/* ==================================================================================================== */
+
+/**
+ * Get "size" zeroed bytes from the allocator
+ */
+void *extcss3_calloc(const extcss3_allocator *allocator, size_t size)
+{
+	void *ptr;
+
+	if ((ptr = EXTCSS3_MALLOC(allocator, size)) == NULL) {
+		return NULL;
+	}
+
+	return memset(ptr, 0, size);
+}
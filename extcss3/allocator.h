@@ -0,0 +1,21 @@
+#ifndef EXTCSS3_ALLOCATOR_H
+#define EXTCSS3_ALLOCATOR_H
+
+#include "types.h"
+
+/* ==================================================================================================== */
+
+#define EXTCSS3_MALLOC(allocator, size)			((allocator)->malloc((allocator)->data, (size)))
+#define EXTCSS3_REALLOC(allocator, ptr, size)	((allocator)->realloc((allocator)->data, (ptr), (size)))
+#define EXTCSS3_FREE(allocator, ptr)			((allocator)->free((allocator)->data, (ptr)))
+
+/* ==================================================================================================== */
+
+/* The allocator of the intern if none is given, uses malloc(), realloc() and free() of the libc */
+extern const extcss3_allocator extcss3_default_allocator;
+
+void *extcss3_calloc(const extcss3_allocator *allocator, size_t size);
+
+/* ==================================================================================================== */
+
+#endif /* EXTCSS3_ALLOCATOR_H */
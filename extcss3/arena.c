@@ -0,0 +1,130 @@
+#include "arena.h"
+#include "allocator.h"
+
+#include <string.h>
+
+/* ==================================================================================================== */
+
+/* Keep every allocation aligned for pointers, sizes and doubles */
+#define _EXTCSS3_ARENA_ALIGN(size)	(((size) + 7) & ~((size_t)7))
+
+/* ==================================================================================================== */
+
+/**
+ * Create a new chunk that is big enough for at least "size" bytes
+ */
+static inline extcss3_chunk *_extcss3_arena_create_chunk(extcss3_arena *arena, extcss3_chunk *prev, size_t size)
+{
+	extcss3_chunk *chunk;
+	size_t len = EXTCSS3_ARENA_CHUNK_MIN;
+
+	if (prev != NULL) {
+		len = prev->size * 2;
+
+		if (len > EXTCSS3_ARENA_CHUNK_MAX) {
+			len = EXTCSS3_ARENA_CHUNK_MAX;
+		}
+	}
+
+	if (len < size) {
+		len = size;
+	}
+
+	if ((chunk = (extcss3_chunk *)EXTCSS3_MALLOC(arena->allocator, sizeof(extcss3_chunk) + len)) == NULL) {
+		return NULL;
+	}
+
+	chunk->next = NULL;
+	chunk->size = len;
+	chunk->used = 0;
+
+	return chunk;
+}
+
+/* ==================================================================================================== */
+
+/**
+ * Get "size" zeroed bytes from the arena. The memory is only given back by the reset or the release of the arena.
+ */
+void *extcss3_arena_alloc(extcss3_arena *arena, size_t size)
+{
+	extcss3_chunk *chunk;
+	void *ptr;
+
+	size = _EXTCSS3_ARENA_ALIGN(size);
+
+	if (arena->curr == NULL) {
+		if ((arena->base = arena->curr = _extcss3_arena_create_chunk(arena, NULL, size)) == NULL) {
+			return NULL;
+		}
+	} else if ((arena->curr->size - arena->curr->used) < size) {
+		// Reuse the chunks that are kept from previous runs before creating a new one
+		while (((chunk = arena->curr->next) != NULL) && (chunk->size < size)) {
+			arena->curr->next = chunk->next;
+			EXTCSS3_FREE(arena->allocator, chunk);
+		}
+
+		if (chunk == NULL) {
+			if ((chunk = _extcss3_arena_create_chunk(arena, arena->curr, size)) == NULL) {
+				return NULL;
+			}
+
+			arena->curr->next = chunk;
+		}
+
+		chunk->used = 0;
+		arena->curr = chunk;
+	}
+
+	ptr = arena->curr->data + arena->curr->used;
+	arena->curr->used += size;
+
+	return memset(ptr, 0, size);
+}
+
+/**
+ * Give back all the memory of the arena at once, but keep the chunks for the next run
+ */
+void extcss3_arena_reset(extcss3_arena *arena)
+{
+	if ((arena->curr = arena->base) != NULL) {
+		arena->base->used = 0;
+	}
+}
+
+/**
+ * Reset the arena and free the chunks that exceed the total size of "max" bytes
+ */
+void extcss3_arena_trim(extcss3_arena *arena, size_t max)
+{
+	extcss3_chunk **chunk = &arena->base, *next;
+	size_t size = 0;
+
+	while (*chunk != NULL) {
+		if ((size += (*chunk)->size) > max) {
+			next = (*chunk)->next;
+			EXTCSS3_FREE(arena->allocator, *chunk);
+			*chunk = next;
+		} else {
+			chunk = &(*chunk)->next;
+		}
+	}
+
+	extcss3_arena_reset(arena);
+}
+
+/**
+ * Free all the chunks of the arena
+ */
+void extcss3_arena_release(extcss3_arena *arena)
+{
+	extcss3_chunk *next;
+
+	while (arena->base != NULL) {
+		next = arena->base->next;
+		EXTCSS3_FREE(arena->allocator, arena->base);
+		arena->base = next;
+	}
+
+	arena->curr = NULL;
+}
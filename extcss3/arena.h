@@ -0,0 +1,21 @@
+#ifndef EXTCSS3_ARENA_H
+#define EXTCSS3_ARENA_H
+
+#include "types.h"
+
+/* ==================================================================================================== */
+
+/* Size of the first chunk of an arena, every following chunk doubles the size up to the maximum */
+#define EXTCSS3_ARENA_CHUNK_MIN		((size_t)64 * 1024)
+#define EXTCSS3_ARENA_CHUNK_MAX		((size_t)16 * 1024 * 1024)
+
+/* ==================================================================================================== */
+
+void *extcss3_arena_alloc(extcss3_arena *arena, size_t size);
+void extcss3_arena_reset(extcss3_arena *arena);
+void extcss3_arena_trim(extcss3_arena *arena, size_t max);
+void extcss3_arena_release(extcss3_arena *arena);
+
+/* ==================================================================================================== */
+
+#endif /* EXTCSS3_ARENA_H */
@@ -1,4 +1,5 @@
 #include "dumper.h"
+#include "../allocator.h"
 #include "../intern.h"
 #include "../utils.h"
 #include "../tokenizer/tokenizer.h"
@@ -9,9 +10,17 @@
 
 static void *_extcss3_set_error_code(unsigned int *error, unsigned int code);
 
-static void _extcss3_write_rules(extcss3_rule *rule, char **result);
-static void _extcss3_write_decls(extcss3_decl *decl, char **result);
-static void _extcss3_write_token(extcss3_token *token, char **result);
+static char *_extcss3_alloc_result(extcss3_intern *intern, size_t size);
+
+static size_t _extcss3_size_rules(extcss3_intern *intern, extcss3_rule *rule);
+static size_t _extcss3_size_decls(extcss3_intern *intern, extcss3_decl *decl);
+static size_t _extcss3_size_token(extcss3_intern *intern, extcss3_token *token);
+
+static size_t _extcss3_copy_data(extcss3_intern *intern, extcss3_token *token, char *result);
+
+static void _extcss3_write_rules(extcss3_intern *intern, extcss3_rule *rule, char **result);
+static void _extcss3_write_decls(extcss3_intern *intern, extcss3_decl *decl, char **result);
+static void _extcss3_write_token(extcss3_intern *intern, extcss3_token *token, char **result);
 
 /* ==================================================================================================== */
 
@@ -21,13 +30,17 @@ char *extcss3_dump_rules(extcss3_intern *intern, extcss3_rule *rule, unsigned in
 
 	if ((intern == NULL) || (intern->copy.str == NULL) || (rule == NULL)) {
 		return _extcss3_set_error_code(error, EXTCSS3_ERR_NULL_PTR);
-	} else if ((result = curr = (char *)calloc(intern->copy.len + intern->modifier.user_strlen_diff + 1, sizeof(char))) == NULL) {
+	} else if ((result = curr = _extcss3_alloc_result(intern, _extcss3_size_rules(intern, rule) + 1)) == NULL) {
 		return _extcss3_set_error_code(error, EXTCSS3_ERR_MEMORY);
 	}
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-	_extcss3_write_rules(rule, &curr);
+	_extcss3_write_rules(intern, rule, &curr);
+
+	*curr = '\0';
+
+	intern->output.len = curr - result;
 
 	return result;
 }
@@ -36,6 +49,7 @@ char *extcss3_dump_tokens(extcss3_intern *intern, unsigned int *error)
 {
 	extcss3_token *token;
 	char *result, *pos;
+	size_t size = 1;
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -45,45 +59,65 @@ char *extcss3_dump_tokens(extcss3_intern *intern, unsigned int *error)
 		return _extcss3_set_error_code(error, *error);
 	} else if ((token = intern->base_token) == NULL) {
 		return _extcss3_set_error_code(error, EXTCSS3_ERR_NULL_PTR);
-	} else if ((result = pos = (char *)calloc(intern->copy.len + intern->modifier.user_strlen_diff + 1, sizeof(char))) == NULL) {
+	}
+
+	// Sum up the exact length of the result, see the loop below
+	for (; token != NULL; token = EXTCSS3_TOKEN_NEXT(intern, token)) {
+		if ((EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_URL) || (EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_BAD_URL)) {
+			if (token->flag != EXTCSS3_FLAG_AT_URL_STRING) {
+				size += 4 /* strlen("url(") */ + (EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_URL);
+			}
+		} else if (!token->user_off && (EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_FUNCTION)) {
+			size += 1;
+		}
+
+		size += token->user_off ? token->user_len : token->data_len;
+	}
+
+	if ((result = pos = _extcss3_alloc_result(intern, size)) == NULL) {
 		return _extcss3_set_error_code(error, EXTCSS3_ERR_MEMORY);
 	}
 
+	token = intern->base_token;
+
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 	while (token != NULL) {
-		if ((token->type == EXTCSS3_TYPE_URL) || (token->type == EXTCSS3_TYPE_BAD_URL)) {
+		if ((EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_URL) || (EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_BAD_URL)) {
 			if (token->flag != EXTCSS3_FLAG_AT_URL_STRING) {
 				memcpy(pos, "url(", 4);
 				pos += 4;
 			}
 		}
 
-		if (!token->user.str) {
-			memcpy(pos, token->data.str, token->data.len);
-			pos += token->data.len;
+		if (!token->user_off) {
+			memcpy(pos, EXTCSS3_TOKEN_DATA(intern, token), token->data_len);
+			pos += token->data_len;
 		} else {
-			memcpy(pos, token->user.str, token->user.len);
-			pos += token->user.len;
+			memcpy(pos, EXTCSS3_TOKEN_USER(intern, token), token->user_len);
+			pos += token->user_len;
 		}
 
-		if ((token->type == EXTCSS3_TYPE_URL)) {
+		if ((EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_URL)) {
 			if (token->flag != EXTCSS3_FLAG_AT_URL_STRING) {
 				*pos = ')';
 				pos += 1;
 			}
-		} else if (!token->user.str && (token->type == EXTCSS3_TYPE_FUNCTION)) {
+		} else if (!token->user_off && (EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_FUNCTION)) {
 			*pos = '(';
 			pos += 1;
 		}
 
-		token = token->next;
+		token = EXTCSS3_TOKEN_NEXT(intern, token);
 	}
 
+	*pos = '\0';
+
+	intern->output.len = pos - result;
+
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-	extcss3_release_tokens_list(intern->base_token);
-	intern->base_token = NULL;
+	extcss3_release_tokens_list(intern);
 
 	return result;
 }
@@ -97,111 +131,229 @@ static inline void *_extcss3_set_error_code(unsigned int *error, unsigned int co
 	return NULL;
 }
 
+/**
+ * Get the result buffer from the output allocator of the intern, or from the allocator of the intern if there is none
+ */
+static inline char *_extcss3_alloc_result(extcss3_intern *intern, size_t size)
+{
+	if (intern->output.alloc != NULL) {
+		return intern->output.alloc(intern, size);
+	}
+
+	return (char *)EXTCSS3_MALLOC(&intern->allocator, size);
+}
+
 /* ==================================================================================================== */
 
-static inline void _extcss3_write_rules(extcss3_rule *rule, char **result)
+static inline size_t _extcss3_size_rules(extcss3_intern *intern, extcss3_rule *rule)
 {
 	extcss3_token *token;
+	size_t size = 0;
 
 	while (rule != NULL) {
 		token = rule->base_selector;
 
 		while (token != NULL) {
-			_extcss3_write_token(token, result);
+			size += _extcss3_size_token(intern, token);
 
 			if (token == rule->last_selector) {
 				break;
 			}
 
-			token = token->next;
+			token = EXTCSS3_TOKEN_NEXT(intern, token);
 		}
 
 		if (rule->block != NULL) {
-			memcpy(*result, rule->block->base->data.str, rule->block->base->data.len);
-			*result += rule->block->base->data.len;
+			size += rule->block->base->data_len;
 
 			if (rule->block->rules != NULL) {
-				_extcss3_write_rules(rule->block->rules, result);
+				size += _extcss3_size_rules(intern, rule->block->rules);
 			} else if (rule->block->decls != NULL) {
-				_extcss3_write_decls(rule->block->decls, result);
+				size += _extcss3_size_decls(intern, rule->block->decls);
 			}
 
-			memcpy(*result, rule->block->last->data.str, rule->block->last->data.len);
-			*result += rule->block->last->data.len;
+			size += rule->block->last->data_len;
 		}
 
 		rule = rule->next;
 	}
+
+	return size;
 }
 
-static inline void _extcss3_write_decls(extcss3_decl *decl, char **result)
+static inline size_t _extcss3_size_decls(extcss3_intern *intern, extcss3_decl *decl)
 {
 	extcss3_token *token;
+	size_t size = 0;
 
 	while (decl != NULL) {
 		token = decl->base;
 
 		while (token != NULL) {
-			_extcss3_write_token(token, result);
+			size += _extcss3_size_token(intern, token);
 
 			if (token == decl->last) {
 				break;
 			}
 
-			token = token->next;
+			token = EXTCSS3_TOKEN_NEXT(intern, token);
 		}
 
 		decl = decl->next;
 	}
+
+	return size;
 }
 
-static inline void _extcss3_write_token(extcss3_token *token, char **result)
+/**
+ * The number of bytes _extcss3_write_token() writes for the token
+ */
+static inline size_t _extcss3_size_token(extcss3_intern *intern, extcss3_token *token)
 {
-	size_t writer, reader;
+	size_t size = 0;
 
-	if ((token->type == EXTCSS3_TYPE_URL) || (token->type == EXTCSS3_TYPE_BAD_URL)) {
+	if ((EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_URL) || (EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_BAD_URL)) {
 		if (token->flag != EXTCSS3_FLAG_AT_URL_STRING) {
-			memcpy(*result, "url(", 4);
-			*result += 4;
+			size += 4 /* strlen("url(") */ + (EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_URL);
 		}
+	} else if ((token->user_off == 0) && (EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_FUNCTION)) {
+		size += 1;
 	}
 
-	if (_EXTCSS3_TYPE_EMPTY_EX(token)) {
-		**result = ' ';
-		*result += 1;
-	} else if (token->user.str == NULL) {
-		for (writer = 0, reader = 0; reader < token->data.len; writer++, reader++) {
-			if ((token->type == EXTCSS3_TYPE_URL) || (token->type == EXTCSS3_TYPE_STRING)) {
-				if (token->data.str[reader] == '\\' && token->data.str[reader + 1] == '\n') {
-					writer--;
-					reader++;
-					continue;
-				}
+	if (_EXTCSS3_TYPE_EMPTY_EX(intern, token)) {
+		size += 1;
+	} else if (token->user_off == 0) {
+		size += _extcss3_copy_data(intern, token, NULL);
+	} else {
+		size += token->user_len;
+	}
+
+	return size;
+}
+
+/**
+ * Copy the data of the token without escaped newlines and with shortened "\0..." escapes, nothing is copied
+ * for a NULL result. Returns the number of bytes.
+ */
+static inline size_t _extcss3_copy_data(extcss3_intern *intern, extcss3_token *token, char *result)
+{
+	const char *data = EXTCSS3_TOKEN_DATA(intern, token);
+	size_t writer, reader;
+
+	for (writer = 0, reader = 0; reader < token->data_len; writer++, reader++) {
+		if ((EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_URL) || (EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_STRING)) {
+			if (data[reader] == '\\' && data[reader + 1] == '\n') {
+				writer--;
+				reader++;
+				continue;
+			}
+		}
+
+		if (reader + 1 < token->data_len && data[reader] == '\\' && data[reader + 1] == '0') {
+			if (result != NULL) {
+				result[writer] = data[reader];
+			}
+
+			writer++;
+			reader++;
+
+			// Keep the last '0' of the escape if no other hex digit follows
+			while (reader + 1 < token->data_len && data[reader] == '0' && EXTCSS3_IS_HEX(data[reader + 1])) {
+				reader++;
+			}
+		}
+
+		if (result != NULL) {
+			result[writer] = data[reader];
+		}
+	}
+
+	return writer;
+}
+
+/* ==================================================================================================== */
+
+static inline void _extcss3_write_rules(extcss3_intern *intern, extcss3_rule *rule, char **result)
+{
+	extcss3_token *token;
+
+	while (rule != NULL) {
+		token = rule->base_selector;
+
+		while (token != NULL) {
+			_extcss3_write_token(intern, token, result);
+
+			if (token == rule->last_selector) {
+				break;
 			}
 
-			if (reader + 1 < token->data.len && token->data.str[reader] == '\\' && token->data.str[reader + 1] == '0') {
-				(*result)[writer++] = token->data.str[reader++];
+			token = EXTCSS3_TOKEN_NEXT(intern, token);
+		}
+
+		if (rule->block != NULL) {
+			memcpy(*result, EXTCSS3_TOKEN_DATA(intern, rule->block->base), rule->block->base->data_len);
+			*result += rule->block->base->data_len;
 
-				while (reader < token->data.len && token->data.str[reader] == '0') {
-					reader++;
-				}
+			if (rule->block->rules != NULL) {
+				_extcss3_write_rules(intern, rule->block->rules, result);
+			} else if (rule->block->decls != NULL) {
+				_extcss3_write_decls(intern, rule->block->decls, result);
 			}
 
-			(*result)[writer] = token->data.str[reader];
+			memcpy(*result, EXTCSS3_TOKEN_DATA(intern, rule->block->last), rule->block->last->data_len);
+			*result += rule->block->last->data_len;
 		}
 
-		*result += writer;
+		rule = rule->next;
+	}
+}
+
+static inline void _extcss3_write_decls(extcss3_intern *intern, extcss3_decl *decl, char **result)
+{
+	extcss3_token *token;
+
+	while (decl != NULL) {
+		token = decl->base;
+
+		while (token != NULL) {
+			_extcss3_write_token(intern, token, result);
+
+			if (token == decl->last) {
+				break;
+			}
+
+			token = EXTCSS3_TOKEN_NEXT(intern, token);
+		}
+
+		decl = decl->next;
+	}
+}
+
+static inline void _extcss3_write_token(extcss3_intern *intern, extcss3_token *token, char **result)
+{
+	if ((EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_URL) || (EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_BAD_URL)) {
+		if (token->flag != EXTCSS3_FLAG_AT_URL_STRING) {
+			memcpy(*result, "url(", 4);
+			*result += 4;
+		}
+	}
+
+	if (_EXTCSS3_TYPE_EMPTY_EX(intern, token)) {
+		**result = ' ';
+		*result += 1;
+	} else if (token->user_off == 0) {
+		*result += _extcss3_copy_data(intern, token, *result);
 	} else {
-		memcpy(*result, token->user.str, token->user.len);
-		*result += token->user.len;
+		memcpy(*result, EXTCSS3_TOKEN_USER(intern, token), token->user_len);
+		*result += token->user_len;
 	}
 
-	if ((token->type == EXTCSS3_TYPE_URL)) {
+	if ((EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_URL)) {
 		if (token->flag != EXTCSS3_FLAG_AT_URL_STRING) {
 			**result = ')';
 			*result += 1;
 		}
-	} else if ((token->user.str == NULL) && (token->type == EXTCSS3_TYPE_FUNCTION)) {
+	} else if ((token->user_off == 0) && (EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_FUNCTION)) {
 		**result = '(';
 		*result += 1;
 	}
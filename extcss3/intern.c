@@ -1,67 +1,361 @@
 #include "intern.h"
+#include "allocator.h"
+#include "arena.h"
+#include "utils.h"
+#include "tokenizer/preprocessor.h"
 
 #include <stdio.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+/* ==================================================================================================== */
+
+/**
+ * Check that the string contains none of the bytes '\r', '\f', '\0' and '\\' which need the preprocessing
+ */
+static inline bool _extcss3_check_is_prepared(const char *str, size_t len)
+{
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	const __m128i cr = _mm_set1_epi8('\r'), ff = _mm_set1_epi8('\f'), nul = _mm_setzero_si128(), bs = _mm_set1_epi8('\\');
+	__m128i chunk, found;
+
+	for (; (i + 16) <= len; i += 16) {
+		chunk = _mm_loadu_si128((const __m128i *)(str + i));
+		found = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, ff)),
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, nul), _mm_cmpeq_epi8(chunk, bs))
+		);
+
+		if (_mm_movemask_epi8(found) != 0) {
+			return EXTCSS3_FAILURE;
+		}
+	}
+#endif
+
+	for (; i < len; i++) {
+		if ((str[i] == '\r') || (str[i] == '\f') || (str[i] == '\0') || (str[i] == '\\')) {
+			return EXTCSS3_FAILURE;
+		}
+	}
+
+	return EXTCSS3_SUCCESS;
+}
+
+/**
+ * Count the number of bytes the preprocessed copy of the string can grow by, "gap" gets the part of the escapes
+ */
+static inline size_t _extcss3_count_growth(const char *str, size_t len, size_t *gap)
+{
+	size_t i, nul = 0, esc = 0;
+
+	for (i = 0; i < len; i++) {
+		nul += (str[i] == '\0');
+		esc += (str[i] == '\\');
+	}
+
+	*gap = esc;
+
+	return (nul << 1) + esc;
+}
+
 /* ==================================================================================================== */
 
-extcss3_intern *extcss3_create_intern(void)
+/**
+ * Create an intern that allocates everything by the given allocator, or by the libc for NULL
+ */
+extcss3_intern *extcss3_create_intern(const extcss3_allocator *allocator)
 {
-	return (extcss3_intern *)calloc(1, sizeof(extcss3_intern));
+	extcss3_intern *intern;
+
+	if (allocator == NULL) {
+		allocator = &extcss3_default_allocator;
+	}
+
+	if ((intern = (extcss3_intern *)extcss3_calloc(allocator, sizeof(extcss3_intern))) != NULL) {
+		intern->allocator = *allocator;
+		intern->high_water = EXTCSS3_HIGH_WATER_MARK;
+
+		intern->rule_arena.allocator = intern->block_arena.allocator = intern->decl_arena.allocator = &intern->allocator;
+	}
+
+	return intern;
 }
 
-extcss3_vendor *extcss3_create_vendor(void)
+extcss3_vendor *extcss3_create_vendor(extcss3_intern *intern)
 {
-	return (extcss3_vendor *)calloc(1, sizeof(extcss3_vendor));
+	return (extcss3_vendor *)extcss3_calloc(&intern->allocator, sizeof(extcss3_vendor));
 }
 
-extcss3_token *extcss3_create_token(void)
+extcss3_token *extcss3_create_token(extcss3_intern *intern)
 {
-	return (extcss3_token *)calloc(1, sizeof(extcss3_token));
+	extcss3_token *tokens;
+	uint8_t *types;
+	uint32_t base, last;
+	size_t size;
+
+	// The index 0 is reserved for "no token"
+	if (intern->tokens_len == 0) {
+		intern->tokens_len = 1;
+	}
+
+	if (intern->tokens_len >= intern->tokens_size) {
+		size = (intern->tokens_size == 0) ? EXTCSS3_TOKENS_SIZE : (intern->tokens_size * 2);
+
+		if (size > UINT32_MAX) {
+			return NULL;
+		}
+
+		base = EXTCSS3_TOKEN_INDEX(intern, intern->base_token);
+		last = EXTCSS3_TOKEN_INDEX(intern, intern->last_token);
+
+		if ((types = (uint8_t *)EXTCSS3_REALLOC(&intern->allocator, intern->types, size * sizeof(uint8_t))) == NULL) {
+			return NULL;
+		}
+
+		intern->types = types;
+
+		if ((tokens = (extcss3_token *)EXTCSS3_REALLOC(&intern->allocator, intern->tokens, size * sizeof(extcss3_token))) == NULL) {
+			return NULL;
+		}
+
+		intern->tokens = tokens;
+		intern->tokens_size = size;
+
+		// The tokens may have been moved
+		intern->base_token = EXTCSS3_TOKEN(intern, base);
+		intern->last_token = EXTCSS3_TOKEN(intern, last);
+	}
+
+	intern->types[intern->tokens_len] = EXTCSS3_UNDEFINED;
+
+	return (extcss3_token *)memset(intern->tokens + intern->tokens_len++, 0, sizeof(extcss3_token));
+}
+
+/**
+ * Get a zeroed number for the numeric token. Returns NULL if the allocation fails or all indices are taken.
+ */
+extcss3_number *extcss3_create_number(extcss3_intern *intern, extcss3_token *token)
+{
+	extcss3_number *numbers;
+	size_t size;
+
+	// The index 0 is reserved for "no number"
+	if (intern->numbers_len == 0) {
+		intern->numbers_len = 1;
+	}
+
+	if (intern->numbers_len > EXTCSS3_NUMBERS_MAX) {
+		return NULL;
+	} else if (intern->numbers_len >= intern->numbers_size) {
+		size = (intern->numbers_size == 0) ? EXTCSS3_NUMBERS_SIZE : (intern->numbers_size * 2);
+
+		if ((numbers = (extcss3_number *)EXTCSS3_REALLOC(&intern->allocator, intern->numbers, size * sizeof(extcss3_number))) == NULL) {
+			return NULL;
+		}
+
+		intern->numbers = numbers;
+		intern->numbers_size = size;
+	}
+
+	token->id = intern->numbers_len;
+
+	return (extcss3_number *)memset(intern->numbers + intern->numbers_len++, 0, sizeof(extcss3_number));
+}
+
+/**
+ * Get "len" zeroed bytes for the user string of the token. The pointer is valid until the next call.
+ */
+char *extcss3_create_user_str(extcss3_intern *intern, extcss3_token *token, size_t len)
+{
+	char *strings;
+	size_t size;
+
+	// The offset 0 is reserved for "no user string"
+	if (intern->strings_len == 0) {
+		intern->strings_len = 1;
+	}
+
+	if ((intern->strings_len + len) > intern->strings_size) {
+		size = (intern->strings_size == 0) ? EXTCSS3_STRINGS_SIZE : intern->strings_size;
+
+		while (size < (intern->strings_len + len)) {
+			size *= 2;
+		}
+
+		if (size > UINT32_MAX) {
+			return NULL;
+		} else if ((strings = (char *)EXTCSS3_REALLOC(&intern->allocator, intern->strings, size)) == NULL) {
+			return NULL;
+		}
+
+		intern->strings = strings;
+		intern->strings_size = size;
+	}
+
+	token->user_off = intern->strings_len;
+	token->user_len = len;
+
+	intern->strings_len += len;
+
+	return (char *)memset(intern->strings + token->user_off, 0, len);
 }
 
-extcss3_ctxt *extcss3_create_ctxt(void)
+/**
+ * Use the static string "str" as user string of the token. Each static string is copied only once per run.
+ */
+bool extcss3_set_user_const(extcss3_intern *intern, extcss3_token *token, const char *str, size_t len)
 {
-	return (extcss3_ctxt *)calloc(1, sizeof(extcss3_ctxt));
+	extcss3_const *slot = &intern->consts[(((uintptr_t)str) ^ ((uintptr_t)str >> 6)) % EXTCSS3_CONSTS_SIZE];
+	char *user;
+
+	if ((slot->str == str) && (slot->len == len)) {
+		token->user_off = slot->off;
+		token->user_len = slot->len;
+
+		return EXTCSS3_SUCCESS;
+	} else if ((user = extcss3_create_user_str(intern, token, len)) == NULL) {
+		return EXTCSS3_FAILURE;
+	}
+
+	memcpy(user, str, len);
+
+	slot->str = str;
+	slot->off = token->user_off;
+	slot->len = token->user_len;
+
+	return EXTCSS3_SUCCESS;
 }
 
-extcss3_rule *extcss3_create_rule(void)
+extcss3_rule *extcss3_create_rule(extcss3_intern *intern)
 {
-	return (extcss3_rule *)calloc(1, sizeof(extcss3_rule));
+	return (extcss3_rule *)extcss3_arena_alloc(&intern->rule_arena, sizeof(extcss3_rule));
 }
 
-extcss3_block *extcss3_create_block(void)
+extcss3_block *extcss3_create_block(extcss3_intern *intern)
 {
-	return (extcss3_block *)calloc(1, sizeof(extcss3_block));
+	return (extcss3_block *)extcss3_arena_alloc(&intern->block_arena, sizeof(extcss3_block));
 }
 
-extcss3_decl *extcss3_create_decl(void)
+extcss3_decl *extcss3_create_decl(extcss3_intern *intern)
 {
-	return (extcss3_decl *)calloc(1, sizeof(extcss3_decl));
+	return (extcss3_decl *)extcss3_arena_alloc(&intern->decl_arena, sizeof(extcss3_decl));
 }
 
 /* ==================================================================================================== */
 
+/**
+ * Shrink the buffer to "size" bytes, the bigger buffer is kept if the allocator can not shrink it
+ */
+static inline void *_extcss3_shrink_buffer(extcss3_intern *intern, void *ptr, size_t size)
+{
+	void *shrunk;
+
+	if (size == 0) {
+		EXTCSS3_FREE(&intern->allocator, ptr);
+
+		return NULL;
+	} else if ((shrunk = EXTCSS3_REALLOC(&intern->allocator, ptr, size)) == NULL) {
+		return ptr;
+	}
+
+	return shrunk;
+}
+
+/**
+ * Drop the results of the last run, but keep the buffers up to the high-water mark for the next run
+ */
+void extcss3_reset_intern(extcss3_intern *intern)
+{
+	size_t size;
+
+	if (intern == NULL) {
+		return;
+	}
+
+	extcss3_release_tokens_list(intern);
+	extcss3_release_rules_list(intern);
+
+	// The parallel arrays of the tokens grow together and are shrunk together
+	size = sizeof(extcss3_token) + sizeof(uint8_t);
+
+	if ((intern->tokens_size * size) > intern->high_water) {
+		intern->tokens_size = intern->high_water / size;
+
+		intern->tokens = (extcss3_token *)_extcss3_shrink_buffer(intern, intern->tokens, intern->tokens_size * sizeof(extcss3_token));
+		intern->types = (uint8_t *)_extcss3_shrink_buffer(intern, intern->types, intern->tokens_size * sizeof(uint8_t));
+	}
+
+	if ((intern->numbers_size * sizeof(extcss3_number)) > intern->high_water) {
+		intern->numbers_size = intern->high_water / sizeof(extcss3_number);
+		intern->numbers = (extcss3_number *)_extcss3_shrink_buffer(intern, intern->numbers, intern->numbers_size * sizeof(extcss3_number));
+	}
+
+	if (intern->strings_size > intern->high_water) {
+		intern->strings_size = intern->high_water;
+		intern->strings = (char *)_extcss3_shrink_buffer(intern, intern->strings, intern->strings_size);
+	}
+
+	extcss3_arena_trim(&intern->rule_arena, intern->high_water);
+	extcss3_arena_trim(&intern->block_arena, intern->high_water);
+	extcss3_arena_trim(&intern->decl_arena, intern->high_water);
+
+	if (intern->buffer.len > intern->high_water) {
+		intern->buffer.len = intern->high_water;
+		intern->buffer.str = (char *)_extcss3_shrink_buffer(intern, intern->buffer.str, intern->buffer.len);
+	}
+
+	// The copy-string may point to the original string of the caller
+	intern->copy.str = NULL;
+	intern->copy.len = 0;
+}
+
 void extcss3_release_intern(extcss3_intern *intern)
 {
+	extcss3_allocator allocator;
+
 	if (intern == NULL) {
 		return;
 	}
 
-	if (intern->copy.str != NULL) {
-		free(intern->copy.str);
+	if (intern->buffer.str != NULL) {
+		EXTCSS3_FREE(&intern->allocator, intern->buffer.str);
 	}
 
 	if (intern->base_vendor != NULL) {
-		extcss3_release_vendors_list(intern->base_vendor);
+		extcss3_release_vendors_list(intern, intern->base_vendor);
 	}
 
-	if (intern->base_token != NULL) {
-		extcss3_release_tokens_list(intern->base_token);
+	if (intern->tokens != NULL) {
+		EXTCSS3_FREE(&intern->allocator, intern->tokens);
 	}
 
+	if (intern->types != NULL) {
+		EXTCSS3_FREE(&intern->allocator, intern->types);
+	}
+
+	if (intern->numbers != NULL) {
+		EXTCSS3_FREE(&intern->allocator, intern->numbers);
+	}
+
+	if (intern->strings != NULL) {
+		EXTCSS3_FREE(&intern->allocator, intern->strings);
+	}
+
+	extcss3_arena_release(&intern->rule_arena);
+	extcss3_arena_release(&intern->block_arena);
+	extcss3_arena_release(&intern->decl_arena);
+
 	if (intern->base_ctxt != NULL) {
-		extcss3_release_ctxts_list(intern->base_ctxt);
+		EXTCSS3_FREE(&intern->allocator, intern->base_ctxt);
+	}
+
+	if (intern->patches != NULL) {
+		EXTCSS3_FREE(&intern->allocator, intern->patches);
 	}
 
 	if (intern->modifier.destructor != NULL) {
@@ -86,23 +380,26 @@ void extcss3_release_intern(extcss3_intern *intern)
 		}
 	}
 
-	free(intern);
+	// The allocator is part of the intern itself
+	allocator = intern->allocator;
+
+	EXTCSS3_FREE(&allocator, intern);
 }
 
-void extcss3_release_vendor(extcss3_vendor *vendor)
+void extcss3_release_vendor(extcss3_intern *intern, extcss3_vendor *vendor)
 {
 	if (vendor == NULL) {
 		return;
 	}
 
 	if (vendor->name.str != NULL) {
-		free(vendor->name.str);
+		EXTCSS3_FREE(&intern->allocator, vendor->name.str);
 	}
 
-	free(vendor);
+	EXTCSS3_FREE(&intern->allocator, vendor);
 }
 
-void extcss3_release_vendors_list(extcss3_vendor *list)
+void extcss3_release_vendors_list(extcss3_intern *intern, extcss3_vendor *list)
 {
 	extcss3_vendor *next;
 
@@ -112,188 +409,281 @@ void extcss3_release_vendors_list(extcss3_vendor *list)
 
 	while (list->next != NULL) {
 		next = list->next->next;
-		extcss3_release_vendor(list->next);
+		extcss3_release_vendor(intern, list->next);
 		list->next = next;
 	}
 
-	extcss3_release_vendor(list);
+	extcss3_release_vendor(intern, list);
 }
 
-void extcss3_release_token(extcss3_token *token)
+void extcss3_release_tokens_list(extcss3_intern *intern)
 {
-	if (token == NULL) {
+	if (intern == NULL) {
 		return;
 	}
 
-	if (token->user.str != NULL) {
-		free(token->user.str);
-	}
-
-	free(token);
+	// The tokens, their numbers and their user strings are dropped at once, but the arrays are kept
+	intern->tokens_len = intern->numbers_len = intern->strings_len = 0;
+	memset(intern->consts, 0, sizeof(intern->consts));
+	intern->base_token = intern->last_token = NULL;
 }
 
-void extcss3_release_tokens_list(extcss3_token *list)
+void extcss3_release_rules_list(extcss3_intern *intern)
 {
-	extcss3_token *next;
-
-	if (list == NULL) {
+	if (intern == NULL) {
 		return;
 	}
 
-	while (list->next != NULL) {
-		next = list->next->next;
-		extcss3_release_token(list->next);
-		list->next = next;
-	}
-
-	extcss3_release_token(list);
+	// All rules, blocks and declarations of the tree are dropped at once
+	extcss3_arena_reset(&intern->rule_arena);
+	extcss3_arena_reset(&intern->block_arena);
+	extcss3_arena_reset(&intern->decl_arena);
 }
 
-void extcss3_release_ctxt(extcss3_ctxt *ctxt)
+/* ==================================================================================================== */
+
+bool extcss3_set_css_string(extcss3_intern *intern, char *css, size_t len, unsigned int *error)
 {
-	if (ctxt == NULL) {
-		return;
-	}
+	size_t gap;
 
-	free(ctxt);
-}
+	if ((intern == NULL) || (css == NULL)) {
+		*error = EXTCSS3_ERR_NULL_PTR;
 
-void extcss3_release_ctxts_list(extcss3_ctxt *list)
-{
-	extcss3_ctxt *next;
+		return EXTCSS3_FAILURE;
+	} else if (len >= (UINT32_MAX / 3)) {
+		// The tokens address the copy-string by 32-bit offsets
+		*error = EXTCSS3_ERR_INV_PARAM;
 
-	if (list == NULL) {
-		return;
+		return EXTCSS3_FAILURE;
 	}
 
-	while (list->next != NULL) {
-		next = list->next->next;
-		extcss3_release_ctxt(list->next);
-		list->next = next;
-	}
+	intern->orig.str = css;
+	intern->orig.len = len;
 
-	extcss3_release_ctxt(list);
-}
+	/* Force EOF at the end of the original string */
+	intern->orig.str[intern->orig.len] = '\0';
 
-void extcss3_release_rule(extcss3_rule *rule)
-{
-	if (rule == NULL) {
-		return;
-	}
+	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-	if (rule->block != NULL) {
-		extcss3_release_block(rule->block);
-	}
+	/**
+	 * Without any byte to preprocess, the tokenizer works directly on the
+	 * original string and the copy-string is not needed at all.
+	 */
 
-	free(rule);
-}
+	if ((intern->state.zero_copy = _extcss3_check_is_prepared(css, len))) {
+		intern->copy.str = css;
+		intern->copy.len = len;
 
-void extcss3_release_rules_list(extcss3_rule *list)
-{
-	extcss3_rule *next;
+		gap = 0;
+	} else {
+		/**
+		 * The copy-string needs room for the U+FFFD REPLACEMENT CHARACTERS: every
+		 * '\0' byte grows by 2 bytes and every invalid escape by at most 1 byte.
+		 */
 
-	if (list == NULL) {
-		return;
-	}
+		intern->copy.len = len + _extcss3_count_growth(css, len, &gap);
 
-	while (list->next != NULL) {
-		next = list->next->next;
-		extcss3_release_rule(list->next);
-		list->next = next;
-	}
+		// Reuse the buffer of the previous run if it is big enough
+		if (intern->buffer.len < (intern->copy.len + 1 + EXTCSS3_COPY_PADDING)) {
+			if (intern->buffer.str != NULL) {
+				EXTCSS3_FREE(&intern->allocator, intern->buffer.str);
+			}
 
-	extcss3_release_rule(list);
-}
+			if ((intern->buffer.str = (char *)EXTCSS3_MALLOC(&intern->allocator, intern->copy.len + 1 + EXTCSS3_COPY_PADDING)) == NULL) {
+				intern->buffer.len = 0;
+				*error = EXTCSS3_ERR_MEMORY;
 
-void extcss3_release_block(extcss3_block *block)
-{
-	if (block == NULL) {
-		return;
-	}
+				return EXTCSS3_FAILURE;
+			}
 
-	if (block->rules != NULL) {
-		extcss3_release_rules_list(block->rules);
-	}
+			intern->buffer.len = intern->copy.len + 1 + EXTCSS3_COPY_PADDING;
+		}
 
-	if (block->decls != NULL) {
-		extcss3_release_decls_list(block->decls);
+		intern->copy.str = intern->buffer.str;
 	}
 
-	free(block);
-}
+	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-void extcss3_release_decl(extcss3_decl *decl)
-{
-	if (decl == NULL) {
-		return;
-	}
+	/**
+	 * The preprocessor writes the normalized string to the "cursor" pointer, behind
+	 * a gap for the growth of the escapes. While tokenizing, the normalized bytes
+	 * are moved in front of the "writer" pointer, see extcss3_preprocess_move().
+	 */
 
-	free(decl);
+	intern->state.rest = len;
+	intern->state.reader = intern->state.writer = intern->copy.str;
+	intern->state.cursor = intern->copy.str + gap;
+	intern->state.chunked = false;
+
+	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+	intern->base_token = intern->last_token = NULL;
+	intern->last_ctxt = NULL;
+
+	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+	return EXTCSS3_SUCCESS;
 }
 
-void extcss3_release_decls_list(extcss3_decl *list)
+/**
+ * Start a css string that is pushed in chunks by extcss3_push_css_chunk() afterwards
+ */
+bool extcss3_set_css_chunked(extcss3_intern *intern, unsigned int *error)
 {
-	extcss3_decl *next;
+	if (intern == NULL) {
+		*error = EXTCSS3_ERR_NULL_PTR;
 
-	if (list == NULL) {
-		return;
+		return EXTCSS3_FAILURE;
 	}
 
-	while (list->next != NULL) {
-		next = list->next->next;
-		extcss3_release_decl(list->next);
-		list->next = next;
+	// Room for the terminating '\0' and the padding of the still empty copy-string
+	if (intern->buffer.len < (1 + EXTCSS3_COPY_PADDING)) {
+		if (intern->buffer.str != NULL) {
+			EXTCSS3_FREE(&intern->allocator, intern->buffer.str);
+		}
+
+		if ((intern->buffer.str = (char *)EXTCSS3_MALLOC(&intern->allocator, 1 + EXTCSS3_COPY_PADDING)) == NULL) {
+			intern->buffer.len = 0;
+			*error = EXTCSS3_ERR_MEMORY;
+
+			return EXTCSS3_FAILURE;
+		}
+
+		intern->buffer.len = 1 + EXTCSS3_COPY_PADDING;
 	}
 
-	extcss3_release_decl(list);
-}
+	intern->orig.str = NULL;
+	intern->orig.len = 0;
 
-/* ==================================================================================================== */
+	intern->copy.str = (char *)memset(intern->buffer.str, 0, 1 + EXTCSS3_COPY_PADDING);
+	intern->copy.len = 0;
 
-bool extcss3_set_css_string(extcss3_intern *intern, char *css, size_t len, unsigned int *error)
+	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+	/**
+	 * The chunks are normalized right in front of the "writer" pointer, so
+	 * there is no gap and no rest. The room for the growth of the escapes is
+	 * added behind the writer for every chunk, see extcss3_push_css_chunk().
+	 */
+
+	intern->state.rest = 0;
+	intern->state.reader = intern->state.writer = intern->state.cursor = intern->copy.str;
+	intern->state.zero_copy = intern->state.is_ascii = false;
+	intern->state.chunked = true;
+	intern->state.finished = false;
+	intern->state.ahead = intern->state.escapes = 0;
+	intern->state.tail_len = 0;
+
+	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+	intern->base_token = intern->last_token = NULL;
+	intern->last_ctxt = NULL;
+
+	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+	return EXTCSS3_SUCCESS;
+}
+
+/**
+ * Append the next chunk of the css string, "last" marks the end of the css string
+ *
+ * The tokens can be taken by extcss3_next_token() in between, it returns NULL without any error if it needs the
+ * next chunk. In the "stream" mode of the tokenizer the bytes in front of the kept tokens are dropped here.
+ */
+bool extcss3_push_css_chunk(extcss3_intern *intern, const char *chunk, size_t len, bool last, unsigned int *error)
 {
-	if ((intern == NULL) || (css == NULL)) {
+	extcss3_token *token;
+	size_t drop, gap, size;
+	char *str;
+
+	if ((intern == NULL) || (intern->copy.str == NULL) || ((chunk == NULL) && (len > 0))) {
 		*error = EXTCSS3_ERR_NULL_PTR;
 
 		return EXTCSS3_FAILURE;
-	} else if (intern->copy.str != NULL) {
-		free(intern->copy.str);
+	} else if (!intern->state.chunked || intern->state.finished) {
+		*error = EXTCSS3_ERR_INV_PARAM;
+
+		return EXTCSS3_FAILURE;
 	}
 
-	intern->orig.str = css;
-	intern->orig.len = len;
+	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-	/* Force EOF at the end of the original string */
-	intern->orig.str[intern->orig.len] = '\0';
+	if (intern->state.stream) {
+		drop = intern->state.reader - intern->copy.str;
+
+		if ((intern->base_token != NULL) && (intern->base_token->data_off < drop)) {
+			drop = intern->base_token->data_off;
+		}
+
+		if (drop > 0) {
+			memmove(intern->copy.str, intern->copy.str + drop, (intern->state.writer - intern->copy.str) - drop);
+
+			for (token = intern->base_token; token != NULL; token = EXTCSS3_TOKEN_NEXT(intern, token)) {
+				token->data_off -= drop;
+			}
+
+			intern->state.reader -= drop;
+			intern->state.writer -= drop;
+			intern->state.cursor -= drop;
+
+			_extcss3_count_growth(intern->copy.str, intern->state.writer - intern->copy.str, &intern->state.escapes);
+		}
+	}
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 	/**
-	 * We need at least 3x more memory for the copy-string to be able to put the
-	 * U+FFFD REPLACEMENT CHARACTERS without expensive memory movement operations.
+	 * The normalized chunk needs room for the U+FFFD REPLACEMENT CHARACTERS of its
+	 * own '\0' bytes and escapes, and of the escapes of the previous chunks.
 	 */
 
-	intern->copy.len = len * 3;
-	intern->copy.str = (char *)calloc(intern->copy.len + 1, sizeof(char));
+	size = (intern->state.writer - intern->copy.str) + intern->state.escapes + intern->state.tail_len + len;
+	size += _extcss3_count_growth(chunk, len, &gap) + 1 + EXTCSS3_COPY_PADDING;
 
-	if (intern->copy.str == NULL) {
-		*error = EXTCSS3_ERR_MEMORY;
+	if (size >= (UINT32_MAX / 3)) {
+		// The tokens address the copy-string by 32-bit offsets
+		*error = EXTCSS3_ERR_INV_PARAM;
 
 		return EXTCSS3_FAILURE;
+	} else if (intern->buffer.len < size) {
+		if ((str = (char *)EXTCSS3_REALLOC(&intern->allocator, intern->buffer.str, (size > (intern->buffer.len * 2)) ? size : (intern->buffer.len * 2))) == NULL) {
+			*error = EXTCSS3_ERR_MEMORY;
+
+			return EXTCSS3_FAILURE;
+		}
+
+		// The buffer may have been moved
+		intern->state.reader = str + (intern->state.reader - intern->copy.str);
+		intern->state.writer = str + (intern->state.writer - intern->copy.str);
+		intern->state.cursor = str + (intern->state.cursor - intern->copy.str);
+
+		intern->buffer.len = (size > (intern->buffer.len * 2)) ? size : (intern->buffer.len * 2);
+		intern->buffer.str = intern->copy.str = str;
 	}
 
-	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+	if (EXTCSS3_SUCCESS != extcss3_preprocess_chunk(intern, chunk, len, last, error)) {
+		return EXTCSS3_FAILURE;
+	}
 
-	intern->state.rest = len;
-	intern->state.cursor = intern->orig.str;
-	intern->state.reader = intern->state.writer = intern->copy.str;
+	memset(intern->state.writer, 0, (intern->copy.str + size) - intern->state.writer);
 
-	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+	intern->copy.len = intern->state.writer - intern->copy.str;
+	intern->state.cursor = intern->state.writer;
+	intern->state.escapes += gap;
+	intern->state.finished = last;
 
-	intern->base_token = intern->last_token = NULL;
-	intern->base_ctxt = intern->last_ctxt = NULL;
+	return EXTCSS3_SUCCESS;
+}
 
-	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+bool extcss3_set_high_water_mark(extcss3_intern *intern, size_t size, unsigned int *error)
+{
+	if (intern == NULL) {
+		*error = EXTCSS3_ERR_NULL_PTR;
+
+		return EXTCSS3_FAILURE;
+	}
+
+	intern->high_water = size;
 
 	return EXTCSS3_SUCCESS;
 }
@@ -372,7 +762,7 @@ bool extcss3_set_vendor_string(extcss3_intern *intern, char *name, size_t len, u
 	}
 
 	intern->last_vendor->name.len = len;
-	intern->last_vendor->name.str = (char *)calloc(intern->last_vendor->name.len, sizeof(char));
+	intern->last_vendor->name.str = (char *)extcss3_calloc(&intern->allocator, intern->last_vendor->name.len);
 
 	if (intern->last_vendor->name.str == NULL) {
 		*error = EXTCSS3_ERR_MEMORY;
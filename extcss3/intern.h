@@ -5,28 +5,46 @@
 
 /* ==================================================================================================== */
 
-extcss3_intern *extcss3_create_intern(void);
-extcss3_vendor *extcss3_create_vendor(void);
-extcss3_token *extcss3_create_token(void);
-extcss3_ctxt *extcss3_create_ctxt(void);
-extcss3_rule *extcss3_create_rule(void);
-extcss3_block *extcss3_create_block(void);
-extcss3_decl *extcss3_create_decl(void);
+/* Initial number of tokens and bytes of user strings of an intern */
+#define EXTCSS3_TOKENS_SIZE			((size_t)1024)
+#define EXTCSS3_STRINGS_SIZE		((size_t)4096)
 
+/* Initial number of numbers of an intern, and the highest index that fits into the ID of a token */
+#define EXTCSS3_NUMBERS_SIZE		((size_t)256)
+#define EXTCSS3_NUMBERS_MAX			((size_t)0xFFFFFF)
+
+/* Number of zeroed bytes behind the terminating '\0' of the preprocessed copy-string */
+#define EXTCSS3_COPY_PADDING		((size_t)16)
+
+/* Initial number of remembered escape replacements, see extcss3_next_token() */
+#define EXTCSS3_PATCHES_SIZE		((size_t)16)
+
+/* Default number of bytes per buffer that are kept between the runs of an intern */
+#define EXTCSS3_HIGH_WATER_MARK		((size_t)8 * 1024 * 1024)
+
+/* ==================================================================================================== */
+
+extcss3_intern *extcss3_create_intern(const extcss3_allocator *allocator);
+extcss3_vendor *extcss3_create_vendor(extcss3_intern *intern);
+extcss3_token *extcss3_create_token(extcss3_intern *intern);
+extcss3_number *extcss3_create_number(extcss3_intern *intern, extcss3_token *token);
+char *extcss3_create_user_str(extcss3_intern *intern, extcss3_token *token, size_t len);
+bool extcss3_set_user_const(extcss3_intern *intern, extcss3_token *token, const char *str, size_t len);
+extcss3_rule *extcss3_create_rule(extcss3_intern *intern);
+extcss3_block *extcss3_create_block(extcss3_intern *intern);
+extcss3_decl *extcss3_create_decl(extcss3_intern *intern);
+
+void extcss3_reset_intern(extcss3_intern *intern);
 void extcss3_release_intern(extcss3_intern *intern);
-void extcss3_release_vendor(extcss3_vendor *vendor);
-void extcss3_release_vendors_list(extcss3_vendor *list);
-void extcss3_release_token(extcss3_token *token);
-void extcss3_release_tokens_list(extcss3_token *list);
-void extcss3_release_ctxt(extcss3_ctxt *ctxt);
-void extcss3_release_ctxts_list(extcss3_ctxt *list);
-void extcss3_release_rule(extcss3_rule *rule);
-void extcss3_release_rules_list(extcss3_rule *list);
-void extcss3_release_block(extcss3_block *block);
-void extcss3_release_decl(extcss3_decl *decl);
-void extcss3_release_decls_list(extcss3_decl *list);
+void extcss3_release_vendor(extcss3_intern *intern, extcss3_vendor *vendor);
+void extcss3_release_vendors_list(extcss3_intern *intern, extcss3_vendor *list);
+void extcss3_release_tokens_list(extcss3_intern *intern);
+void extcss3_release_rules_list(extcss3_intern *intern);
 
 bool extcss3_set_css_string(extcss3_intern *intern, char *css, size_t len, unsigned int *error);
+bool extcss3_set_css_chunked(extcss3_intern *intern, unsigned int *error);
+bool extcss3_push_css_chunk(extcss3_intern *intern, const char *chunk, size_t len, bool last, unsigned int *error);
+bool extcss3_set_high_water_mark(extcss3_intern *intern, size_t size, unsigned int *error);
 bool extcss3_set_modifier(extcss3_intern *intern, unsigned int type, void *callable, unsigned int *error);
 bool extcss3_set_vendor_string(extcss3_intern *intern, char *name, size_t len, unsigned int *error);
 
@@ -0,0 +1,211 @@
+#include "keywords.h"
+#include "utils.h"
+
+#include <string.h>
+
+/* ==================================================================================================== */
+
+/**
+ * Seed and size of the perfect hash of the keywords, see _extcss3_keyword_hash()
+ *
+ * Both the seed and the table _extcss3_keyword_slots[] are generated. After a change of the keywords (and of their
+ * IDs in keywords.h) run "php scripts/gen_keywords.php", which searches the first seed that puts every keyword
+ * into a slot of its own and rewrites the two in place. If there is no such seed, double the number of slots.
+ */
+#define _EXTCSS3_KEYWORD_SEED	((uint32_t)0x7B560)
+#define _EXTCSS3_KEYWORD_SLOTS	((size_t)512)
+
+/* ==================================================================================================== */
+
+/**
+ * The keywords by their ID (lower case)
+ */
+const char *extcss3_keywords[EXTCSS3_KEYWORDS] = {
+	"",
+	"@charset",
+	"@import",
+	"@namespace",
+	"@media",
+	"rgb",
+	"aliceblue",
+	"antiquewhite",
+	"aquamarine",
+	"black",
+	"blanchedalmond",
+	"blueviolet",
+	"burlywood",
+	"cadetblue",
+	"chartreuse",
+	"chocolate",
+	"cornflowerblue",
+	"cornsilk",
+	"darkblue",
+	"darkcyan",
+	"darkgoldenrod",
+	"darkgray",
+	"darkgrey",
+	"darkkhaki",
+	"darkmagenta",
+	"darkolivegreen",
+	"darkorange",
+	"darkorchid",
+	"darksalmon",
+	"darkseagreen",
+	"darkslateblue",
+	"darkslategray",
+	"darkslategrey",
+	"darkturquoise",
+	"darkviolet",
+	"deeppink",
+	"deepskyblue",
+	"dodgerblue",
+	"firebrick",
+	"floralwhite",
+	"forestgreen",
+	"fuchsia",
+	"gainsboro",
+	"ghostwhite",
+	"goldenrod",
+	"greenyellow",
+	"honeydew",
+	"hotpink",
+	"indianred",
+	"lavender",
+	"lavenderblush",
+	"lawngreen",
+	"lemonchiffon",
+	"lightblue",
+	"lightcoral",
+	"lightcyan",
+	"lightgoldenrodyellow",
+	"lightgray",
+	"lightgreen",
+	"lightgrey",
+	"lightpink",
+	"lightsalmon",
+	"lightseagreen",
+	"lightskyblue",
+	"lightslategray",
+	"lightslategrey",
+	"lightsteelblue",
+	"lightyellow",
+	"limegreen",
+	"mediumaquamarine",
+	"mediumblue",
+	"mediumorchid",
+	"mediumpurple",
+	"mediumseagreen",
+	"mediumslateblue",
+	"mediumspringgreen",
+	"mediumturquoise",
+	"mediumvioletred",
+	"midnightblue",
+	"mintcream",
+	"mistyrose",
+	"moccasin",
+	"navajowhite",
+	"olivedrab",
+	"orangered",
+	"palegoldenrod",
+	"palegreen",
+	"paleturquoise",
+	"palevioletred",
+	"papayawhip",
+	"peachpuff",
+	"powderblue",
+	"rebeccapurple",
+	"rosybrown",
+	"royalblue",
+	"saddlebrown",
+	"sandybrown",
+	"seagreen",
+	"seashell",
+	"slateblue",
+	"slategray",
+	"slategrey",
+	"springgreen",
+	"steelblue",
+	"turquoise",
+	"white",
+	"whitesmoke",
+	"yellow",
+	"yellowgreen"
+};
+
+/**
+ * The keyword IDs by the hash of the keyword, 0 for empty slots. No two keywords share a slot, so a name
+ * can only be the keyword in its own slot (generated by scripts/gen_keywords.php, do not edit).
+ */
+static const uint8_t _extcss3_keyword_slots[_EXTCSS3_KEYWORD_SLOTS] = {
+	102,  46,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  70,   0,
+	  0,  67,   0,   0,   0,  19,   0,   0,   0,  71,   0,   0,  50,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,  35,   0,   0,   0,   0,   0,  60,   0,   0,  10,
+	 68,  33,   0,   0,   0,   0,  99,   0,   0,   0,   0,   0,   0,  20,   0,   0,
+	  0,   0,   0,   0,   0,  93,   0,   0,  29,  11,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0, 108,   0,   0,   0,   0,   0,   0,   0,  57,   0,  94,
+	  0,   0,   0,   0,   0,  74,  54,   0,  59,   0,   0,   0,   0,   0,   0,   0,
+	 81,   0,  38,  95,  73,   0,   0,   0,   0,   1,  91,   0,  90,  84,   0,  82,
+	  0,   0,   0,  26,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,  76,   0, 101,   0,   0,   0,   8,   0,   0,   0,  34,   0, 100,
+	 52,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   9,
+	  0,   0,   0,   0,   0,   0,  37,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	 13,  27,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  62,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   3,   0,   0,   0,   0,  87,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,  85,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,  31,   0,   0,  75,   0,  12,  78,   0,   0,  32,   0,   0,   0,  83,
+	  0,   0,   0,   0,   6,   0,   0,   0,   0,   0,   0,  88,   0,  43,   0,   0,
+	  0,   0,   0,  39,   0,   0,   0,   0,   0,   0,   0,   0,   0,  61,  48,   0,
+	  0,  16,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,  58, 106,   0,  66,   0,   0,  96,   0,   0,   0,  28,   0,  92,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  49,   0,   0,   0,
+	  0,   0,   0,   0,  44,   0,   0,   0,   0,   0,   0,   0,   0,   0,   2,   0,
+	  0,   0,  79,   0,   0,   0,   0,   0,   0,  89, 107,   0,   0,  51,   0,   0,
+	  0,   0,  63,  30,   0,  14,   0,   0,   0,   0,  23,   0,  18,  42,   0,   0,
+	  0,   0,  24,   0,  53,   0,  80,  25,  45,   0,   0,  72,   0,  15,   0,   0,
+	 56,   0,   0,   0,   0,  98,   0,   0,   0,   0,   0,   0,  86,   0,   5,   0,
+	 40,   0,  21,   0,   0,   0,  64,   0,   0,   0,  97,   0,  22, 104,   0,   4,
+	 65, 103,   0,   0,   0,  47,  55,   0,   0,   0,   0,  77,  17,   0,   0,   0,
+	  0,  41,   0,  69,   0,   0,   0,   0,   0,   0,   0,  36,   0,   0,   0,   7,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, 105,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0
+};
+
+/* ==================================================================================================== */
+
+/**
+ * FNV-1a hash of the ASCII case folded bytes (the folding of non-letters does not matter, because the
+ * keyword of the slot is compared afterwards)
+ */
+static inline size_t _extcss3_keyword_hash(const char *str, size_t len)
+{
+	uint32_t hash = _EXTCSS3_KEYWORD_SEED;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		hash = (hash ^ ((unsigned char)str[i] | 0x20)) * 0x01000193;
+	}
+
+	return (hash >> 16) & (_EXTCSS3_KEYWORD_SLOTS - 1);
+}
+
+/**
+ * Get the keyword ID of the name of an <ident>, <function> or <at-keyword> token (ASCII case-insensitive)
+ */
+uint8_t extcss3_get_keyword(const char *str, size_t len)
+{
+	uint8_t keyword;
+
+	if ((len < EXTCSS3_KEYWORD_MIN_LEN) || (len > EXTCSS3_KEYWORD_MAX_LEN)) {
+		return EXTCSS3_KEYWORD_NONE;
+	} else if ((keyword = _extcss3_keyword_slots[_extcss3_keyword_hash(str, len)]) == EXTCSS3_KEYWORD_NONE) {
+		return EXTCSS3_KEYWORD_NONE;
+	} else if (
+		(strlen(extcss3_keywords[keyword]) != len) ||
+		(EXTCSS3_SUCCESS != extcss3_ascii_strncasecmp(str, extcss3_keywords[keyword], len))
+	) {
+		return EXTCSS3_KEYWORD_NONE;
+	}
+
+	return keyword;
+}
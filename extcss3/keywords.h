@@ -0,0 +1,37 @@
+#ifndef EXTCSS3_KEYWORDS_H
+#define EXTCSS3_KEYWORDS_H
+
+#include "types.h"
+
+/* ==================================================================================================== */
+
+/* Keyword IDs of the <ident>, <function> and <at-keyword> tokens, see extcss3_get_keyword() */
+#define EXTCSS3_KEYWORD_NONE			((uint8_t)0)
+
+#define EXTCSS3_KEYWORD_AT_CHARSET		((uint8_t)1)
+#define EXTCSS3_KEYWORD_AT_IMPORT		((uint8_t)2)
+#define EXTCSS3_KEYWORD_AT_NAMESPACE	((uint8_t)3)
+#define EXTCSS3_KEYWORD_AT_MEDIA		((uint8_t)4)
+#define EXTCSS3_KEYWORD_RGB				((uint8_t)5)
+
+/* The named colors follow in alphabetical order, see extcss3_minify_color() */
+#define EXTCSS3_KEYWORD_COLOR			((uint8_t)6)
+#define EXTCSS3_KEYWORD_COLORS			((uint8_t)103)
+
+#define EXTCSS3_KEYWORDS				((size_t)EXTCSS3_KEYWORD_COLOR + EXTCSS3_KEYWORD_COLORS)
+
+#define EXTCSS3_KEYWORD_IS_COLOR(k)		(((k) >= EXTCSS3_KEYWORD_COLOR) && ((k) < EXTCSS3_KEYWORDS))
+
+/* Shortest and longest keyword */
+#define EXTCSS3_KEYWORD_MIN_LEN			((size_t)3)
+#define EXTCSS3_KEYWORD_MAX_LEN			((size_t)20)
+
+/* ==================================================================================================== */
+
+extern const char *extcss3_keywords[EXTCSS3_KEYWORDS];
+
+uint8_t extcss3_get_keyword(const char *str, size_t len);
+
+/* ==================================================================================================== */
+
+#endif /* EXTCSS3_KEYWORDS_H */
@@ -4,6 +4,7 @@
 #include "types/hash.h"
 #include "types/function.h"
 #include "../intern.h"
+#include "../keywords.h"
 #include "../utils.h"
 #include "../tokenizer/tokenizer.h"
 #include "../dumper/dumper.h"
@@ -13,7 +14,7 @@
 
 /* ==================================================================================================== */
 
-static void *_extcss3_set_error_code(unsigned int *error, unsigned int code, extcss3_rule *tree, extcss3_intern *intern);
+static void *_extcss3_set_error_code(unsigned int *error, unsigned int code, extcss3_intern *intern);
 
 static extcss3_rule *_extcss3_minify_tree(extcss3_intern *intern, extcss3_rule **tree, unsigned int *error);
 static extcss3_rule *_extcss3_minify_rule(extcss3_intern *intern, extcss3_rule *rule, unsigned int *error);
@@ -21,21 +22,21 @@ static extcss3_token *_extcss3_minify_selectors(extcss3_intern *intern, extcss3_
 static extcss3_block *_extcss3_minify_declarations(extcss3_intern *intern, extcss3_block *block, unsigned int *error);
 static extcss3_decl *_extcss3_minify_declaration(extcss3_intern *intern, extcss3_decl *decl, unsigned int *error);
 
-static extcss3_token *_extcss3_get_decl_name(extcss3_decl *decl);
-static extcss3_token *_extcss3_get_decl_sep(extcss3_token *name, extcss3_decl *decl);
-static extcss3_token *_extcss3_get_decl_value(extcss3_token *last, extcss3_decl *decl);
+static extcss3_token *_extcss3_get_decl_name(extcss3_intern *intern, extcss3_decl *decl);
+static extcss3_token *_extcss3_get_decl_sep(extcss3_intern *intern, extcss3_token *name, extcss3_decl *decl);
+static extcss3_token *_extcss3_get_decl_value(extcss3_intern *intern, extcss3_token *last, extcss3_decl *decl);
 
-static void _extcss3_trim_left(extcss3_token *curr);
-static void _extcss3_trim_right(extcss3_token *curr, extcss3_token **last);
-static void _extcss3_trim_around(extcss3_token *curr, extcss3_token **last);
+static void _extcss3_trim_left(extcss3_intern *intern, extcss3_token *curr);
+static void _extcss3_trim_right(extcss3_intern *intern, extcss3_token *curr, extcss3_token **last);
+static void _extcss3_trim_around(extcss3_intern *intern, extcss3_token *curr, extcss3_token **last);
 
-static void _extcss3_remove_token(extcss3_token **base, extcss3_token **token, extcss3_token *repl);
+static void _extcss3_remove_token(extcss3_intern *intern, extcss3_token **base, extcss3_token **token, extcss3_token *repl);
 
 static bool _extcss3_check_at_rule_is_valid_charset(extcss3_intern *intern, extcss3_rule *rule);
-static bool _extcss3_check_at_rule_is_valid_import(extcss3_rule *rule);
-static bool _extcss3_check_at_rule_is_valid_namespace(extcss3_rule *rule);
+static bool _extcss3_check_at_rule_is_valid_import(extcss3_intern *intern, extcss3_rule *rule);
+static bool _extcss3_check_at_rule_is_valid_namespace(extcss3_intern *intern, extcss3_rule *rule);
 
-static bool _extcss3_check_minify_color(extcss3_token *name, extcss3_token *value);
+static bool _extcss3_check_minify_color(extcss3_intern *intern, extcss3_token *name, extcss3_token *value);
 
 /* ==================================================================================================== */
 
@@ -48,15 +49,15 @@ char *extcss3_minify(extcss3_intern *intern, unsigned int *error)
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 	if ((intern == NULL) || (intern->copy.str == NULL)) {
-		return _extcss3_set_error_code(error, EXTCSS3_ERR_NULL_PTR, NULL, NULL);
+		return _extcss3_set_error_code(error, EXTCSS3_ERR_NULL_PTR, NULL);
 	} else if (EXTCSS3_SUCCESS != extcss3_tokenize(intern, error)) {
-		return _extcss3_set_error_code(error, *error, NULL, NULL);
+		return _extcss3_set_error_code(error, *error, NULL);
 	} else if ((token = intern->base_token) == NULL) {
-		return _extcss3_set_error_code(error, EXTCSS3_ERR_NULL_PTR, NULL, NULL);
-	} else if ((tree = extcss3_create_tree(&token, NULL, 0, error)) == NULL) {
-		return _extcss3_set_error_code(error, *error, NULL, intern);
+		return _extcss3_set_error_code(error, EXTCSS3_ERR_NULL_PTR, NULL);
+	} else if ((tree = extcss3_create_tree(intern, &token, NULL, 0, error)) == NULL) {
+		return _extcss3_set_error_code(error, *error, intern);
 	} else if (tree->base_selector == NULL) {
-		return _extcss3_set_error_code(error, EXTCSS3_ERR_NULL_PTR, tree, intern);
+		return _extcss3_set_error_code(error, EXTCSS3_ERR_NULL_PTR, intern);
 	}
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
@@ -64,33 +65,31 @@ char *extcss3_minify(extcss3_intern *intern, unsigned int *error)
 	_extcss3_minify_tree(intern, &tree, error);
 
 	if (*error != 0) {
-		return _extcss3_set_error_code(error, *error, tree, intern);
+		return _extcss3_set_error_code(error, *error, intern);
 	} else if (tree == NULL) {
-		return _extcss3_set_error_code(error, EXTCSS3_ERR_NULL_PTR, NULL, intern);
+		return _extcss3_set_error_code(error, EXTCSS3_ERR_NULL_PTR, intern);
 	} else if ((result = extcss3_dump_rules(intern, tree, error)) == NULL) {
-		return _extcss3_set_error_code(error, *error, tree, intern);
+		return _extcss3_set_error_code(error, *error, intern);
 	}
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-	_extcss3_set_error_code(error, 0, tree, intern);
+	_extcss3_set_error_code(error, 0, intern);
 
 	return result;
 }
 
 /* ==================================================================================================== */
 
-static inline void *_extcss3_set_error_code(unsigned int *error, unsigned int code, extcss3_rule *tree, extcss3_intern *intern)
+static inline void *_extcss3_set_error_code(unsigned int *error, unsigned int code, extcss3_intern *intern)
 {
 	*error = code;
 
-	if (tree != NULL) {
-		extcss3_release_rules_list(tree);
-	}
+	// Drop the whole tree at once
+	extcss3_release_rules_list(intern);
 
 	if ((intern != NULL) && (intern->base_token != NULL)) {
-		extcss3_release_tokens_list(intern->base_token);
-		intern->base_token = NULL;
+		extcss3_release_tokens_list(intern);
 	}
 
 	return NULL;
@@ -100,9 +99,9 @@ static inline void *_extcss3_set_error_code(unsigned int *error, unsigned int co
 
 static extcss3_rule *_extcss3_minify_tree(extcss3_intern *intern, extcss3_rule **tree, unsigned int *error)
 {
-	extcss3_rule *next, *curr = *tree;
+	extcss3_rule *curr = *tree;
 
-	while ((curr != NULL) && (curr->base_selector != NULL) && (curr->base_selector->type != EXTCSS3_TYPE_EOF)) {
+	while ((curr != NULL) && (curr->base_selector != NULL) && (EXTCSS3_TOKEN_TYPE(intern, curr->base_selector) != EXTCSS3_TYPE_EOF)) {
 		if (_extcss3_minify_rule(intern, curr, error) == NULL) {
 			if (*error > 0) {
 				return NULL;
@@ -120,10 +119,7 @@ static extcss3_rule *_extcss3_minify_tree(extcss3_intern *intern, extcss3_rule *
 				*tree = curr->next;
 			}
 
-			next = curr->next;
-			extcss3_release_rule(curr);
-
-			curr = next;
+			curr = curr->next;
 			continue;
 		}
 
@@ -131,8 +127,6 @@ static extcss3_rule *_extcss3_minify_tree(extcss3_intern *intern, extcss3_rule *
 	}
 
 	if ((*tree)->base_selector == NULL) {
-		extcss3_release_rules_list(*tree);
-
 		*tree = NULL;
 	}
 
@@ -143,7 +137,7 @@ static extcss3_rule *_extcss3_minify_rule(extcss3_intern *intern, extcss3_rule *
 {
 	if ((rule == NULL) && (rule->base_selector == NULL)) {
 		return NULL;
-	} else if (rule->base_selector->type == EXTCSS3_TYPE_EOF) {
+	} else if (EXTCSS3_TOKEN_TYPE(intern, rule->base_selector) == EXTCSS3_TYPE_EOF) {
 		return rule;
 	} else if ((rule->base_selector = _extcss3_minify_selectors(intern, rule, error)) == NULL) {
 		return NULL;
@@ -170,38 +164,34 @@ static extcss3_rule *_extcss3_minify_rule(extcss3_intern *intern, extcss3_rule *
 
 static inline extcss3_token *_extcss3_minify_selectors(extcss3_intern *intern, extcss3_rule *rule, unsigned int *error)
 {
-	extcss3_token *selector, *range_base, *range_last;
+	extcss3_token *selector, *prev, *range_base, *range_last;
 	extcss3_vendor *vendor;
+	char *data;
 	bool preserve_sign;
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 	// Check <at-keyword> tokens "@charset", "@import" and "@namespace"
-	if (rule->base_selector->type == EXTCSS3_TYPE_AT_KEYWORD) {
-		if (
-			(rule->base_selector->data.len == 8 /* strlen("@charset") */) &&
-			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(rule->base_selector->data.str, "@charset", 8)) &&
-			(
-				(rule->level != 0) || (EXTCSS3_SUCCESS != _extcss3_check_at_rule_is_valid_charset(intern, rule))
-			)
-		) {
-			return rule->base_selector = rule->last_selector = NULL;
-		} else if (
-			(rule->base_selector->data.len == 7 /* strlen("@import") */) &&
-			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(rule->base_selector->data.str, "@import", 7)) &&
-			(
-				(rule->level != 0) || (EXTCSS3_SUCCESS != _extcss3_check_at_rule_is_valid_import(rule))
-			)
-		) {
-			return rule->base_selector = rule->last_selector = NULL;
-		} else if (
-			(rule->base_selector->data.len == 10 /* strlen("@namespace") */) &&
-			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(rule->base_selector->data.str, "@namespace", 10)) &&
-			(
-				(rule->level != 0) || (EXTCSS3_SUCCESS != _extcss3_check_at_rule_is_valid_namespace(rule))
-			)
-		) {
-			return rule->base_selector = rule->last_selector = NULL;
+	if (EXTCSS3_TOKEN_TYPE(intern, rule->base_selector) == EXTCSS3_TYPE_AT_KEYWORD) {
+		switch (EXTCSS3_TOKEN_KEYWORD(intern, rule->base_selector)) {
+			case EXTCSS3_KEYWORD_AT_CHARSET:
+				if ((rule->level != 0) || (EXTCSS3_SUCCESS != _extcss3_check_at_rule_is_valid_charset(intern, rule))) {
+					return rule->base_selector = rule->last_selector = NULL;
+				}
+
+				break;
+			case EXTCSS3_KEYWORD_AT_IMPORT:
+				if ((rule->level != 0) || (EXTCSS3_SUCCESS != _extcss3_check_at_rule_is_valid_import(intern, rule))) {
+					return rule->base_selector = rule->last_selector = NULL;
+				}
+
+				break;
+			case EXTCSS3_KEYWORD_AT_NAMESPACE:
+				if ((rule->level != 0) || (EXTCSS3_SUCCESS != _extcss3_check_at_rule_is_valid_namespace(intern, rule))) {
+					return rule->base_selector = rule->last_selector = NULL;
+				}
+
+				break;
 		}
 	}
 
@@ -209,13 +199,13 @@ static inline extcss3_token *_extcss3_minify_selectors(extcss3_intern *intern, e
 
 	selector = rule->last_selector;
 
-	while ((selector != NULL) && _EXTCSS3_TYPE_EMPTY_EX(selector)) {
+	while ((selector != NULL) && _EXTCSS3_TYPE_EMPTY_EX(intern, selector)) {
 		// Trim the trailing whitespace and comments
-		rule->last_selector = selector = selector->prev;
+		rule->last_selector = selector = EXTCSS3_TOKEN_PREV(intern, selector);
 	}
 
 	// Bad case: The last selector token is of type <comma>
-	if (rule->last_selector->type == EXTCSS3_TYPE_COMMA) {
+	if (EXTCSS3_TOKEN_TYPE(intern, rule->last_selector) == EXTCSS3_TYPE_COMMA) {
 		return rule->base_selector = rule->last_selector = NULL;
 	}
 
@@ -226,87 +216,90 @@ static inline extcss3_token *_extcss3_minify_selectors(extcss3_intern *intern, e
 	while (selector != NULL) {
 		// Remove whitespace and comments after...
 		if (
-			(selector->type == EXTCSS3_TYPE_BR_SO)		||
-			(selector->type == EXTCSS3_TYPE_BR_RO)		||
-			(selector->type == EXTCSS3_TYPE_COLON)		||
-			(selector->type == EXTCSS3_TYPE_FUNCTION)	||
-			(selector->type == EXTCSS3_TYPE_STRING)
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_BR_SO)	||
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_BR_RO)	||
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_COLON)	||
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_FUNCTION)	||
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_STRING)
 		) {
-			_extcss3_trim_right(selector, &rule->last_selector);
+			_extcss3_trim_right(intern, selector, &rule->last_selector);
 		}
 
 		// Remove whitespace and comments before...
 		if (
-			(selector->type == EXTCSS3_TYPE_BR_SC)		||
-			(selector->type == EXTCSS3_TYPE_BR_RC)		||
-			(selector->type == EXTCSS3_TYPE_BAD_STRING)	||
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_BR_SC)		||
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_BR_RC)		||
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_BAD_STRING)	||
 			(
-				(selector->type == EXTCSS3_TYPE_STRING) &&
+				(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_STRING) &&
 				(EXTCSS3_SUCCESS != _extcss3_check_at_rule_is_valid_charset(intern, rule))
 			) ||
 			(
-				(selector->type == EXTCSS3_TYPE_BR_RO) &&
-				(selector->prev != NULL) &&
-				(selector->prev->prev != NULL) &&
-				(_EXTCSS3_TYPE_EMPTY_EX(selector->prev)) &&
-				(selector->prev->prev->type != EXTCSS3_TYPE_IDENT)
+				(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_BR_RO) &&
+				(selector->prev != 0) &&
+				(EXTCSS3_TOKEN_PREV(intern, selector)->prev != 0) &&
+				(_EXTCSS3_TYPE_EMPTY_EX(intern, EXTCSS3_TOKEN_PREV(intern, selector))) &&
+				(EXTCSS3_TOKEN_TYPE(intern, EXTCSS3_TOKEN_PREV(intern, EXTCSS3_TOKEN_PREV(intern, selector))) != EXTCSS3_TYPE_IDENT)
 			)
 		) {
-			_extcss3_trim_left(selector);
+			_extcss3_trim_left(intern, selector);
 		}
 
 		// Remove whitespace and comments around...
 		if (
-			(selector->flag == EXTCSS3_FLAG_AT_URL_STRING)	||
-			(selector->type == EXTCSS3_TYPE_COMMA)			||
-			(selector->type == EXTCSS3_TYPE_SUFFIX_MATCH)	||
-			(selector->type == EXTCSS3_TYPE_SUBSTR_MATCH)	||
-			(selector->type == EXTCSS3_TYPE_PREFIX_MATCH)	||
-			(selector->type == EXTCSS3_TYPE_DASH_MATCH)		||
-			(selector->type == EXTCSS3_TYPE_INCLUDE_MATCH)	||
-			(selector->type == EXTCSS3_TYPE_COLUMN)			||
+			(selector->flag == EXTCSS3_FLAG_AT_URL_STRING)							||
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_COMMA)			||
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_SUFFIX_MATCH)		||
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_SUBSTR_MATCH)		||
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_PREFIX_MATCH)		||
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_DASH_MATCH)		||
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_INCLUDE_MATCH)	||
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_COLUMN)			||
 			(
-				(selector->type == EXTCSS3_TYPE_DELIM) &&
+				(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_DELIM) &&
 				(
-					(*selector->data.str == '>') ||
-					(*selector->data.str == '+') ||
-					(*selector->data.str == '~') ||
-					(*selector->data.str == '=')
+					(*EXTCSS3_TOKEN_DATA(intern, selector) == '>') ||
+					(*EXTCSS3_TOKEN_DATA(intern, selector) == '+') ||
+					(*EXTCSS3_TOKEN_DATA(intern, selector) == '~') ||
+					(*EXTCSS3_TOKEN_DATA(intern, selector) == '=')
 				)
 			) ||
 			(
-				(selector->type == EXTCSS3_TYPE_BR_RC) &&
-				(rule->base_selector->type == EXTCSS3_TYPE_AT_KEYWORD) &&
-				(rule->base_selector->data.len == 6 /*strlen("@media")*/) &&
-				(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(rule->base_selector->data.str, "@media", 6))
+				(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_BR_RC) &&
+				(EXTCSS3_TOKEN_TYPE(intern, rule->base_selector) == EXTCSS3_TYPE_AT_KEYWORD) &&
+				(EXTCSS3_TOKEN_KEYWORD(intern, rule->base_selector) == EXTCSS3_KEYWORD_AT_MEDIA)
 			)
 		) {
-			_extcss3_trim_around(selector, &rule->last_selector);
+			_extcss3_trim_around(intern, selector, &rule->last_selector);
 		}
 
-		if (selector->type == EXTCSS3_TYPE_COMMENT) {
-			if ((selector->prev != NULL) && (selector->prev->type == EXTCSS3_TYPE_WS)) {
-				if ((selector->next != NULL) && (selector->next->type == EXTCSS3_TYPE_WS)) {
-					_extcss3_trim_right(selector, &rule->last_selector);
+		if (EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_COMMENT) {
+			if ((selector->prev != 0) && (EXTCSS3_TOKEN_TYPE(intern, EXTCSS3_TOKEN_PREV(intern, selector)) == EXTCSS3_TYPE_WS)) {
+				if ((selector->next != 0) && (EXTCSS3_TOKEN_TYPE(intern, EXTCSS3_TOKEN_NEXT(intern, selector)) == EXTCSS3_TYPE_WS)) {
+					_extcss3_trim_right(intern, selector, &rule->last_selector);
 				}
 			}
 
-			if (selector->user.str == NULL) {
-				_extcss3_remove_token(&rule->base_selector, &selector, selector->next);
+			if (selector->user_off == 0) {
+				_extcss3_remove_token(intern, &rule->base_selector, &selector, EXTCSS3_TOKEN_NEXT(intern, selector));
 				continue;
 			}
 		}
 
+		prev = EXTCSS3_TOKEN_PREV(intern, selector);
+
 		if (
-			(selector->type == EXTCSS3_TYPE_BR_SC)	&&
-			(selector->prev != NULL)				&&
-			(selector->prev->user.str == NULL)		&&
-			(selector->prev->type == EXTCSS3_TYPE_STRING)
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_BR_SC)	&&
+			(prev != NULL)													&&
+			(prev->user_off == 0)											&&
+			(EXTCSS3_TOKEN_TYPE(intern, prev) == EXTCSS3_TYPE_STRING)
 		) {
-			size_t i = 1, n = selector->prev->data.len - 1;
+			size_t i = 1, n = prev->data_len - 1;
+
+			data = EXTCSS3_TOKEN_DATA(intern, prev);
 
 			while (i < n) {
-				if (!EXTCSS3_IS_LETTER(selector->prev->data.str[i]) && (selector->prev->data.str[i] != '-')) {
+				if (!EXTCSS3_IS_LETTER(data[i]) && (data[i] != '-')) {
 					break;
 				}
 
@@ -314,66 +307,66 @@ static inline extcss3_token *_extcss3_minify_selectors(extcss3_intern *intern, e
 			}
 
 			if (i == n) {
-				selector->prev->data.str += 1;
-				selector->prev->data.len -= 2;
+				prev->data_off += 1;
+				prev->data_len -= 2;
 			}
 		}
 
-		if (selector->type == EXTCSS3_TYPE_COMMA) {
+		if (EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_COMMA) {
 			// Bad case: Two <comma> tokens
-			if ((selector->next != NULL) && (selector->next->type == EXTCSS3_TYPE_COMMA)) {
+			if ((selector->next != 0) && (EXTCSS3_TOKEN_TYPE(intern, EXTCSS3_TOKEN_NEXT(intern, selector)) == EXTCSS3_TYPE_COMMA)) {
 				return rule->base_selector = rule->last_selector = NULL;
 			}
 		}
 
 		if (
-			(selector->type == EXTCSS3_TYPE_NUMBER)		||
-			(selector->type == EXTCSS3_TYPE_PERCENTAGE)	||
-			(selector->type == EXTCSS3_TYPE_DIMENSION)
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_NUMBER)		||
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_PERCENTAGE)	||
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_DIMENSION)
 		) {
 			if (
-				(selector->prev != NULL) &&
-				(selector->prev->type == EXTCSS3_TYPE_IDENT) &&
+				(prev != NULL) &&
+				(EXTCSS3_TOKEN_TYPE(intern, prev) == EXTCSS3_TYPE_IDENT) &&
 				(
 					(
-						(selector->prev->data.len == 1) &&
-						(selector->prev->data.str[0] == 'n')
+						(prev->data_len == 1) &&
+						(EXTCSS3_TOKEN_DATA(intern, prev)[0] == 'n')
 					) ||
 					(
-						(selector->prev->data.len == 2) &&
-						((selector->prev->data.str[0] == '-') || (selector->prev->data.str[0] == '+')) &&
-						(selector->prev->data.str[1] == 'n')
+						(prev->data_len == 2) &&
+						((EXTCSS3_TOKEN_DATA(intern, prev)[0] == '-') || (EXTCSS3_TOKEN_DATA(intern, prev)[0] == '+')) &&
+						(EXTCSS3_TOKEN_DATA(intern, prev)[1] == 'n')
 					)
 				)
 			) {
 				preserve_sign = true;
 			} else if (
-				(selector->prev != NULL) &&
-				(selector->prev->type == EXTCSS3_TYPE_DIMENSION) &&
-				(selector->prev->info.len == 1) &&
-				(selector->prev->info.str[0] == 'n')
+				(prev != NULL) &&
+				(EXTCSS3_TOKEN_TYPE(intern, prev) == EXTCSS3_TYPE_DIMENSION) &&
+				(prev->info_len == 1) &&
+				(EXTCSS3_TOKEN_INFO(intern, prev)[0] == 'n')
 			) {
 				preserve_sign = true;
 			} else {
 				preserve_sign = false;
 			}
 
-			if (selector->type == EXTCSS3_TYPE_PERCENTAGE && rule->base_selector == selector && rule->last_selector == selector) {
+			if (EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_PERCENTAGE && rule->base_selector == selector && rule->last_selector == selector) {
 				// Do nothing
 			} else {
-				if (EXTCSS3_SUCCESS != extcss3_minify_numeric(selector, preserve_sign, error)) {
+				if (EXTCSS3_SUCCESS != extcss3_minify_numeric(intern, selector, preserve_sign, error)) {
 					return NULL;
 				}
 			}
 		}
 
-		if ((selector->type == EXTCSS3_TYPE_AT_KEYWORD) && (selector->data.str[1] == '-')) {
+		if ((EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_AT_KEYWORD) && (EXTCSS3_TOKEN_DATA(intern, selector)[1] == '-')) {
 			if ((vendor = intern->base_vendor) != NULL) {
 				while (vendor != NULL) {
 					if (
-						(selector->data.len > vendor->name.len)				&&
-						(selector->data.str[vendor->name.len + 1] == '-')	&&
-						(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(selector->data.str + 2, vendor->name.str + 1, vendor->name.len - 1))
+						(selector->data_len > vendor->name.len)								&&
+						(EXTCSS3_TOKEN_DATA(intern, selector)[vendor->name.len + 1] == '-')	&&
+						(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(EXTCSS3_TOKEN_DATA(intern, selector) + 2, vendor->name.str + 1, vendor->name.len - 1))
 					) {
 						return rule->base_selector = rule->last_selector = NULL;
 					}
@@ -382,26 +375,26 @@ static inline extcss3_token *_extcss3_minify_selectors(extcss3_intern *intern, e
 				}
 			}
 		} else if (
-			(selector->type == EXTCSS3_TYPE_COLON)				&&
-			(selector->prev != NULL)							&&
-			(selector->prev->type == EXTCSS3_TYPE_COLON)		&&
-			(selector->next != NULL)							&&
-			(selector->next->type == EXTCSS3_TYPE_IDENT)		&&
-			(selector->next->data.str[0] == '-')
+			(EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_COLON)								&&
+			(selector->prev != 0)																		&&
+			(EXTCSS3_TOKEN_TYPE(intern, EXTCSS3_TOKEN_PREV(intern, selector)) == EXTCSS3_TYPE_COLON)	&&
+			(selector->next != 0)																		&&
+			(EXTCSS3_TOKEN_TYPE(intern, EXTCSS3_TOKEN_NEXT(intern, selector)) == EXTCSS3_TYPE_IDENT)	&&
+			(EXTCSS3_TOKEN_DATA(intern, EXTCSS3_TOKEN_NEXT(intern, selector))[0] == '-')
 		) {
 			if ((vendor = intern->base_vendor) != NULL) {
 				while (vendor != NULL) {
 					if (
-						(selector->next->data.len > vendor->name.len)		&&
-						(selector->next->data.str[vendor->name.len] == '-')	&&
-						(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(selector->next->data.str + 1, vendor->name.str + 1, vendor->name.len - 1))
+						(EXTCSS3_TOKEN_NEXT(intern, selector)->data_len > vendor->name.len)							&&
+						(EXTCSS3_TOKEN_DATA(intern, EXTCSS3_TOKEN_NEXT(intern, selector))[vendor->name.len] == '-')	&&
+						(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(EXTCSS3_TOKEN_DATA(intern, EXTCSS3_TOKEN_NEXT(intern, selector)) + 1, vendor->name.str + 1, vendor->name.len - 1))
 					) {
 						range_base = range_last = selector;
 
 						while (range_base != NULL) {
-							range_base = range_base->prev;
+							range_base = EXTCSS3_TOKEN_PREV(intern, range_base);
 
-							if ((range_base == rule->base_selector) || (range_base->type == EXTCSS3_TYPE_COMMA)) {
+							if ((range_base == rule->base_selector) || (EXTCSS3_TOKEN_TYPE(intern, range_base) == EXTCSS3_TYPE_COMMA)) {
 								break;
 							}
 						}
@@ -411,12 +404,12 @@ static inline extcss3_token *_extcss3_minify_selectors(extcss3_intern *intern, e
 
 							if (selector == rule->last_selector) {
 								break;
-							} else if (selector->type == EXTCSS3_TYPE_COMMA) {
-								_extcss3_trim_around(selector, &rule->last_selector);
+							} else if (EXTCSS3_TOKEN_TYPE(intern, selector) == EXTCSS3_TYPE_COMMA) {
+								_extcss3_trim_around(intern, selector, &rule->last_selector);
 								break;
 							}
 
-							selector = selector->next;
+							selector = EXTCSS3_TOKEN_NEXT(intern, selector);
 						}
 
 						if ((range_base == rule->base_selector) && (range_last == rule->last_selector)) {
@@ -428,32 +421,32 @@ static inline extcss3_token *_extcss3_minify_selectors(extcss3_intern *intern, e
 							// |--,----|
 							// A-B,----|
 							// >>>>|---|
-							rule->base_selector = range_last->next;
+							rule->base_selector = EXTCSS3_TOKEN_NEXT(intern, range_last);
 						} else if (range_last == rule->last_selector) {
 							// |---,---|
 							// |----,A-B
 							// |---|<<<<
-							rule->last_selector = range_base->prev;
+							rule->last_selector = EXTCSS3_TOKEN_PREV(intern, range_base);
 
 							selector = rule->last_selector;
 						} else {
 							// |-,---,-|
 							// |-,A-B,-|
 							// |-,XXXX-|
-							if ((range_base->type == EXTCSS3_TYPE_COMMA) && (range_last->type == EXTCSS3_TYPE_COMMA)) {
-								range_base = range_base->next;
+							if ((EXTCSS3_TOKEN_TYPE(intern, range_base) == EXTCSS3_TYPE_COMMA) && (EXTCSS3_TOKEN_TYPE(intern, range_last) == EXTCSS3_TYPE_COMMA)) {
+								range_base = EXTCSS3_TOKEN_NEXT(intern, range_base);
 							}
 
 							while ((range_base != NULL) && (range_base != range_last)) {
-								_extcss3_remove_token(&rule->base_selector, &range_base, range_base->next);
+								_extcss3_remove_token(intern, &rule->base_selector, &range_base, EXTCSS3_TOKEN_NEXT(intern, range_base));
 
 								selector = range_base;
 							}
 
 							if ((range_base != NULL) && (range_base == range_last)) {
-								_extcss3_remove_token(&rule->base_selector, &range_base, NULL);
+								_extcss3_remove_token(intern, &rule->base_selector, &range_base, NULL);
 
-								selector = range_last->next;
+								selector = EXTCSS3_TOKEN_NEXT(intern, range_last);
 							}
 						}
 
@@ -470,7 +463,7 @@ static inline extcss3_token *_extcss3_minify_selectors(extcss3_intern *intern, e
 		}
 
 		if (selector != NULL) {
-			selector = selector->next;
+			selector = EXTCSS3_TOKEN_NEXT(intern, selector);
 		}
 	}
 
@@ -481,7 +474,7 @@ static inline extcss3_token *_extcss3_minify_selectors(extcss3_intern *intern, e
 
 static inline extcss3_block *_extcss3_minify_declarations(extcss3_intern *intern, extcss3_block *block, unsigned int *error)
 {
-	extcss3_decl *curr, *temp;
+	extcss3_decl *curr;
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -490,7 +483,6 @@ static inline extcss3_block *_extcss3_minify_declarations(extcss3_intern *intern
 	while (curr != NULL) {
 		if (_extcss3_minify_declaration(intern, curr, error) == NULL) {
 			if (*error > 0) {
-				extcss3_release_block(block);
 				return NULL;
 			}
 
@@ -502,7 +494,7 @@ static inline extcss3_block *_extcss3_minify_declarations(extcss3_intern *intern
 
 				if (curr->next == NULL) {
 					// Remove last semicolon in the previous declaration
-					curr->prev->last = curr->prev->last->prev;
+					curr->prev->last = EXTCSS3_TOKEN_PREV(intern, curr->prev->last);
 				}
 			}
 
@@ -510,10 +502,7 @@ static inline extcss3_block *_extcss3_minify_declarations(extcss3_intern *intern
 				block->decls = curr->next;
 			}
 
-			temp = curr->next;
-			extcss3_release_decl(curr);
-			curr = temp;
-
+			curr = curr->next;
 			continue;
 		}
 
@@ -523,7 +512,6 @@ static inline extcss3_block *_extcss3_minify_declarations(extcss3_intern *intern
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 	if (block->decls == NULL) {
-		extcss3_release_block(block);
 		return NULL;
 	}
 
@@ -537,37 +525,37 @@ static inline extcss3_decl *_extcss3_minify_declaration(extcss3_intern *intern,
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-	name = _extcss3_get_decl_name(decl);
+	name = _extcss3_get_decl_name(intern, decl);
 
 	if (name != NULL) {
-		_extcss3_trim_around(name, &decl->last);
+		_extcss3_trim_around(intern, name, &decl->last);
 
-		sep = _extcss3_get_decl_sep(name, decl);
+		sep = _extcss3_get_decl_sep(intern, name, decl);
 
 		if (sep != NULL) {
-			_extcss3_trim_around(sep, &decl->last);
+			_extcss3_trim_around(intern, sep, &decl->last);
 
-			value = _extcss3_get_decl_value(sep, decl);
+			value = _extcss3_get_decl_value(intern, sep, decl);
 		}
 	}
 
 	if (
 		(name == NULL) || (sep == NULL) || (value == NULL) ||
-		(value->type == EXTCSS3_TYPE_COLON) ||
-		(value->type == EXTCSS3_TYPE_SEMICOLON)
+		(EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_COLON) ||
+		(EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_SEMICOLON)
 	) {
 		return NULL;
 	}
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-	if ((name->type == EXTCSS3_TYPE_IDENT) && (name->data.str[0] == '-')) {
+	if ((EXTCSS3_TOKEN_TYPE(intern, name) == EXTCSS3_TYPE_IDENT) && (EXTCSS3_TOKEN_DATA(intern, name)[0] == '-')) {
 		if ((vendor = intern->base_vendor) != NULL) {
 			while (vendor != NULL) {
 				if (
-					(name->data.len > vendor->name.len)			&&
-					(name->data.str[vendor->name.len] == '-')	&&
-					(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(name->data.str + 1, vendor->name.str + 1, vendor->name.len - 1))
+					(name->data_len > vendor->name.len)							&&
+					(EXTCSS3_TOKEN_DATA(intern, name)[vendor->name.len] == '-')	&&
+					(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(EXTCSS3_TOKEN_DATA(intern, name) + 1, vendor->name.str + 1, vendor->name.len - 1))
 				) {
 					return NULL;
 				}
@@ -581,8 +569,8 @@ static inline extcss3_decl *_extcss3_minify_declaration(extcss3_intern *intern,
 
 	// Remove the leading whitespace and comments
 	while (decl->last != decl->base) {
-		if (_EXTCSS3_TYPE_EMPTY_EX(decl->last)) {
-			decl->last = decl->last->prev;
+		if (_EXTCSS3_TYPE_EMPTY_EX(intern, decl->last)) {
+			decl->last = EXTCSS3_TOKEN_PREV(intern, decl->last);
 			continue;
 		}
 
@@ -592,38 +580,38 @@ static inline extcss3_decl *_extcss3_minify_declaration(extcss3_intern *intern,
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 	while (value != NULL) {
-		if ((value->type == EXTCSS3_TYPE_BAD_STRING) || (value->type == EXTCSS3_TYPE_BAD_URL)) {
+		if ((EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_BAD_STRING) || (EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_BAD_URL)) {
 			return NULL;
 		}
 
 		// Remove whitespace and comments after...
 		if (
-			(value->type == EXTCSS3_TYPE_FUNCTION) ||
-			(value->type == EXTCSS3_TYPE_BR_RO)
+			(EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_FUNCTION) ||
+			(EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_BR_RO)
 		) {
-			_extcss3_trim_right(value, &decl->last);
+			_extcss3_trim_right(intern, value, &decl->last);
 		}
 
 		// Remove whitespace and comments before...
 		if (
-			(value->type == EXTCSS3_TYPE_BR_RC) ||
-			((value->type == EXTCSS3_TYPE_DELIM) && (*value->data.str == '!'))
+			(EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_BR_RC) ||
+			((EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_DELIM) && (*EXTCSS3_TOKEN_DATA(intern, value) == '!'))
 		) {
-			_extcss3_trim_left(value);
+			_extcss3_trim_left(intern, value);
 
-			if ((*value->data.str == '+') || (*value->data.str == '-')) {
-				temp = value->next;
+			if ((*EXTCSS3_TOKEN_DATA(intern, value) == '+') || (*EXTCSS3_TOKEN_DATA(intern, value) == '-')) {
+				temp = EXTCSS3_TOKEN_NEXT(intern, value);
 
-				while ((temp != NULL) &&_EXTCSS3_TYPE_EMPTY(temp->type)) {
-					temp = temp->next;
+				while ((temp != NULL) &&_EXTCSS3_TYPE_EMPTY(EXTCSS3_TOKEN_TYPE(intern, temp))) {
+					temp = EXTCSS3_TOKEN_NEXT(intern, temp);
 				}
 
 				if (
-					(temp->type != EXTCSS3_TYPE_NUMBER)		&&
-					(temp->type != EXTCSS3_TYPE_PERCENTAGE)	&&
-					(temp->type != EXTCSS3_TYPE_DIMENSION)
+					(EXTCSS3_TOKEN_TYPE(intern, temp) != EXTCSS3_TYPE_NUMBER)		&&
+					(EXTCSS3_TOKEN_TYPE(intern, temp) != EXTCSS3_TYPE_PERCENTAGE)	&&
+					(EXTCSS3_TOKEN_TYPE(intern, temp) != EXTCSS3_TYPE_DIMENSION)
 				) {
-					_extcss3_trim_right(value, &decl->last);
+					_extcss3_trim_right(intern, value, &decl->last);
 					value = temp;
 					continue;
 				}
@@ -632,39 +620,39 @@ static inline extcss3_decl *_extcss3_minify_declaration(extcss3_intern *intern,
 
 		// Remove whitespace and comments around...
 		if (
-			(value->type == EXTCSS3_TYPE_COMMA) ||
-			(value->type == EXTCSS3_TYPE_STRING) ||
-			(value->type == EXTCSS3_TYPE_SEMICOLON) ||
+			(EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_COMMA) ||
+			(EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_STRING) ||
+			(EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_SEMICOLON) ||
 			(
-				(value->type == EXTCSS3_TYPE_DELIM) &&
+				(EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_DELIM) &&
 				(
-					(*value->data.str == '*') ||
-					(*value->data.str == '/') ||
-					(*value->data.str == '=')
+					(*EXTCSS3_TOKEN_DATA(intern, value) == '*') ||
+					(*EXTCSS3_TOKEN_DATA(intern, value) == '/') ||
+					(*EXTCSS3_TOKEN_DATA(intern, value) == '=')
 				)
 			)
 		) {
-			_extcss3_trim_around(value, &decl->last);
+			_extcss3_trim_around(intern, value, &decl->last);
 		}
 
 		// Remove the trailing whitespace
 		if (value == decl->last) {
-			if (value->type == EXTCSS3_TYPE_WS) {
-				decl->last = decl->last->prev;
+			if (EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_WS) {
+				decl->last = EXTCSS3_TOKEN_PREV(intern, decl->last);
 
-				_extcss3_trim_left(value);
+				_extcss3_trim_left(intern, value);
 			}
 		}
 
 		/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-		if ((value->data.str[0] == '-')) {
+		if ((EXTCSS3_TOKEN_DATA(intern, value)[0] == '-')) {
 			if ((vendor = intern->base_vendor) != NULL) {
 				while (vendor != NULL) {
 					if (
-						(value->data.len > vendor->name.len)		&&
-						(value->data.str[vendor->name.len] == '-')	&&
-						(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(value->data.str + 1, vendor->name.str + 1, vendor->name.len - 1))
+						(value->data_len > vendor->name.len)							&&
+						(EXTCSS3_TOKEN_DATA(intern, value)[vendor->name.len] == '-')	&&
+						(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(EXTCSS3_TOKEN_DATA(intern, value) + 1, vendor->name.str + 1, vendor->name.len - 1))
 					) {
 						return NULL;
 					}
@@ -676,54 +664,51 @@ static inline extcss3_decl *_extcss3_minify_declaration(extcss3_intern *intern,
 
 		/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-		if (value->user.str != NULL) {
-			value = _extcss3_get_decl_value(value, decl);
+		if (value->user_off != 0) {
+			value = _extcss3_get_decl_value(intern, value, decl);
 			continue;
-		} else if ((decl->next == NULL) && (value->type == EXTCSS3_TYPE_SEMICOLON)) {
-			decl->last = value->prev;
+		} else if ((decl->next == NULL) && (EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_SEMICOLON)) {
+			decl->last = EXTCSS3_TOKEN_PREV(intern, value);
 			break;
-		} else if (value->type == EXTCSS3_TYPE_HASH) {
-			if (EXTCSS3_SUCCESS != extcss3_minify_hash(value->data.str + 1, value->data.len - 1, value, error)) {
+		} else if (EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_HASH) {
+			if (EXTCSS3_SUCCESS != extcss3_minify_hash(intern, EXTCSS3_TOKEN_DATA(intern, value) + 1, value->data_len - 1, value, error)) {
 				return NULL;
 			}
-		} else if (EXTCSS3_SUCCESS == _extcss3_check_minify_color(name, value)) {
-			if (EXTCSS3_SUCCESS != extcss3_minify_color(value, error)) {
+		} else if (EXTCSS3_SUCCESS == _extcss3_check_minify_color(intern, name, value)) {
+			if (EXTCSS3_SUCCESS != extcss3_minify_color(intern, value, error)) {
 				return NULL;
 			}
 		} else if (
-			(value->type == EXTCSS3_TYPE_NUMBER)		||
-			(value->type == EXTCSS3_TYPE_PERCENTAGE)	||
-			(value->type == EXTCSS3_TYPE_DIMENSION)
+			(EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_NUMBER)		||
+			(EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_PERCENTAGE)	||
+			(EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_DIMENSION)
 		) {
-			if (EXTCSS3_SUCCESS != extcss3_minify_numeric(value, false, error)) {
+			if (EXTCSS3_SUCCESS != extcss3_minify_numeric(intern, value, false, error)) {
 				return NULL;
 			}
-		} else if (value->type == EXTCSS3_TYPE_FUNCTION) {
+		} else if (EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_FUNCTION) {
 			// RGB and RGBA version:
 			//if (
-			//	((value->data.len == 3) || (value->data.len == 4)) &&
-			//	(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(value->data.str, "rgba", value->data.len))
+			//	((value->data_len == 3) || (value->data_len == 4)) &&
+			//	(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(EXTCSS3_TOKEN_DATA(intern, value), "rgba", value->data_len))
 			//)
 
 			// RGB only version:
-			if (
-				(value->data.len == 3) &&
-				(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(value->data.str, "rgb", 3))
-			) {
-				if (EXTCSS3_SUCCESS != extcss3_minify_function_rgb_a(&value, decl, error)) {
+			if (EXTCSS3_TOKEN_KEYWORD(intern, value) == EXTCSS3_KEYWORD_RGB) {
+				if (EXTCSS3_SUCCESS != extcss3_minify_function_rgb_a(intern, &value, decl, error)) {
 					return NULL;
 				}
 
-				if ((decl->next == NULL) && (value->type == EXTCSS3_TYPE_SEMICOLON)) {
-					decl->last = value->prev;
+				if ((decl->next == NULL) && (EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_SEMICOLON)) {
+					decl->last = EXTCSS3_TOKEN_PREV(intern, value);
 					break;
-				} else if (value->type == EXTCSS3_TYPE_BR_CC) {
+				} else if (EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_BR_CC) {
 					break;
 				}
 			}
 		}
 
-		value = _extcss3_get_decl_value(value, decl);
+		value = _extcss3_get_decl_value(intern, value, decl);
 	}
 
 	return decl;
@@ -731,15 +716,15 @@ static inline extcss3_decl *_extcss3_minify_declaration(extcss3_intern *intern,
 
 /* ==================================================================================================== */
 
-static inline extcss3_token *_extcss3_get_decl_name(extcss3_decl *decl)
+static inline extcss3_token *_extcss3_get_decl_name(extcss3_intern *intern, extcss3_decl *decl)
 {
-	extcss3_token *curr = decl->base, *term = decl->last->next;
+	extcss3_token *curr = decl->base, *term = EXTCSS3_TOKEN_NEXT(intern, decl->last);
 
 	while ((curr != NULL) && (curr != term)) {
-		if (_EXTCSS3_TYPE_EMPTY(curr->type)) {
-			curr = curr->next;
+		if (_EXTCSS3_TYPE_EMPTY(EXTCSS3_TOKEN_TYPE(intern, curr))) {
+			curr = EXTCSS3_TOKEN_NEXT(intern, curr);
 			continue;
-		} else if ((curr->type == EXTCSS3_TYPE_IDENT) || (curr->type == EXTCSS3_TYPE_DELIM)) {
+		} else if ((EXTCSS3_TOKEN_TYPE(intern, curr) == EXTCSS3_TYPE_IDENT) || (EXTCSS3_TOKEN_TYPE(intern, curr) == EXTCSS3_TYPE_DELIM)) {
 			return curr;
 		}
 
@@ -749,22 +734,22 @@ static inline extcss3_token *_extcss3_get_decl_name(extcss3_decl *decl)
 	return NULL;
 }
 
-static inline extcss3_token *_extcss3_get_decl_sep(extcss3_token *name, extcss3_decl *decl)
+static inline extcss3_token *_extcss3_get_decl_sep(extcss3_intern *intern, extcss3_token *name, extcss3_decl *decl)
 {
-	extcss3_token *curr = name->next, *term = decl->last->next;
+	extcss3_token *curr = EXTCSS3_TOKEN_NEXT(intern, name), *term = EXTCSS3_TOKEN_NEXT(intern, decl->last);
 
 	while ((curr != NULL) && (curr != term)) {
 		if (
-			_EXTCSS3_TYPE_EMPTY(curr->type) ||
+			_EXTCSS3_TYPE_EMPTY(EXTCSS3_TOKEN_TYPE(intern, curr)) ||
 			(
-				(name->type == EXTCSS3_TYPE_DELIM) &&
-				(curr->type == EXTCSS3_TYPE_IDENT) &&
-				(curr == name->next)
+				(EXTCSS3_TOKEN_TYPE(intern, name) == EXTCSS3_TYPE_DELIM) &&
+				(EXTCSS3_TOKEN_TYPE(intern, curr) == EXTCSS3_TYPE_IDENT) &&
+				(curr == EXTCSS3_TOKEN_NEXT(intern, name))
 			)
 		) {
-			curr = curr->next;
+			curr = EXTCSS3_TOKEN_NEXT(intern, curr);
 			continue;
-		} else if (curr->type == EXTCSS3_TYPE_COLON) {
+		} else if (EXTCSS3_TOKEN_TYPE(intern, curr) == EXTCSS3_TYPE_COLON) {
 			return curr;
 		}
 
@@ -774,27 +759,27 @@ static inline extcss3_token *_extcss3_get_decl_sep(extcss3_token *name, extcss3_
 	return NULL;
 }
 
-static inline extcss3_token *_extcss3_get_decl_value(extcss3_token *last, extcss3_decl *decl)
+static inline extcss3_token *_extcss3_get_decl_value(extcss3_intern *intern, extcss3_token *last, extcss3_decl *decl)
 {
-	extcss3_token *curr = last->next, *term = decl->last->next;
+	extcss3_token *curr = EXTCSS3_TOKEN_NEXT(intern, last), *term = EXTCSS3_TOKEN_NEXT(intern, decl->last);
 
 	while ((curr != NULL) && (curr != term)) {
-		if (curr->type == EXTCSS3_TYPE_WS) {
-			curr = curr->next;
+		if (EXTCSS3_TOKEN_TYPE(intern, curr) == EXTCSS3_TYPE_WS) {
+			curr = EXTCSS3_TOKEN_NEXT(intern, curr);
 			continue;
-		} else if (curr->type == EXTCSS3_TYPE_COMMENT) {
-			if ((curr->prev != NULL) && (curr->prev->type == EXTCSS3_TYPE_WS)) {
-				if ((curr->next != NULL) && (curr->next->type == EXTCSS3_TYPE_WS)) {
-					_extcss3_trim_right(curr, &decl->last);
+		} else if (EXTCSS3_TOKEN_TYPE(intern, curr) == EXTCSS3_TYPE_COMMENT) {
+			if ((curr->prev != 0) && (EXTCSS3_TOKEN_TYPE(intern, EXTCSS3_TOKEN_PREV(intern, curr)) == EXTCSS3_TYPE_WS)) {
+				if ((curr->next != 0) && (EXTCSS3_TOKEN_TYPE(intern, EXTCSS3_TOKEN_NEXT(intern, curr)) == EXTCSS3_TYPE_WS)) {
+					_extcss3_trim_right(intern, curr, &decl->last);
 				}
 			}
 
-			if (curr->user.str == NULL) {
+			if (curr->user_off == 0) {
 				if (
-					((curr->prev != NULL) && (curr->prev->type == EXTCSS3_TYPE_WS)) ||
-					((curr->next != NULL) && (curr->next->type == EXTCSS3_TYPE_WS))
+					((curr->prev != 0) && (EXTCSS3_TOKEN_TYPE(intern, EXTCSS3_TOKEN_PREV(intern, curr)) == EXTCSS3_TYPE_WS)) ||
+					((curr->next != 0) && (EXTCSS3_TOKEN_TYPE(intern, EXTCSS3_TOKEN_NEXT(intern, curr)) == EXTCSS3_TYPE_WS))
 				) {
-					_extcss3_remove_token(&decl->base, &curr, curr->next);
+					_extcss3_remove_token(intern, &decl->base, &curr, EXTCSS3_TOKEN_NEXT(intern, curr));
 					continue;
 				}
 			}
@@ -808,61 +793,57 @@ static inline extcss3_token *_extcss3_get_decl_value(extcss3_token *last, extcss
 
 /* ==================================================================================================== */
 
-static inline void _extcss3_trim_left(extcss3_token *curr)
+static inline void _extcss3_trim_left(extcss3_intern *intern, extcss3_token *curr)
 {
 	extcss3_token *temp;
 
-	while ((curr->prev != NULL) && _EXTCSS3_TYPE_EMPTY_EX(curr->prev)) {
-		if ((temp = curr->prev->prev) != NULL) {
-			temp->next = curr;
-			extcss3_release_token(curr->prev);
-			curr->prev = temp;
+	while ((curr->prev != 0) && _EXTCSS3_TYPE_EMPTY_EX(intern, EXTCSS3_TOKEN_PREV(intern, curr))) {
+		if ((temp = EXTCSS3_TOKEN_PREV(intern, EXTCSS3_TOKEN_PREV(intern, curr))) != NULL) {
+			temp->next = EXTCSS3_TOKEN_INDEX(intern, curr);
+			curr->prev = EXTCSS3_TOKEN_INDEX(intern, temp);
 		}
 	}
 }
 
-static inline void _extcss3_trim_right(extcss3_token *curr, extcss3_token **last)
+static inline void _extcss3_trim_right(extcss3_intern *intern, extcss3_token *curr, extcss3_token **last)
 {
 	extcss3_token *temp;
 
-	while ((curr->next != NULL) && _EXTCSS3_TYPE_EMPTY_EX(curr->next)) {
-		if ((temp = curr->next->next) != NULL) {
-			if ((last != NULL) && (*last != NULL) && (curr->next == *last)) {
+	while ((curr->next != 0) && _EXTCSS3_TYPE_EMPTY_EX(intern, EXTCSS3_TOKEN_NEXT(intern, curr))) {
+		if ((temp = EXTCSS3_TOKEN_NEXT(intern, EXTCSS3_TOKEN_NEXT(intern, curr))) != NULL) {
+			if ((last != NULL) && (*last != NULL) && (EXTCSS3_TOKEN_NEXT(intern, curr) == *last)) {
 				*last = curr;
 			}
 
-			temp->prev = curr;
-			extcss3_release_token(curr->next);
-			curr->next = temp;
+			temp->prev = EXTCSS3_TOKEN_INDEX(intern, curr);
+			curr->next = EXTCSS3_TOKEN_INDEX(intern, temp);
 		}
 	}
 }
 
-static inline void _extcss3_trim_around(extcss3_token *curr, extcss3_token **last)
+static inline void _extcss3_trim_around(extcss3_intern *intern, extcss3_token *curr, extcss3_token **last)
 {
-	_extcss3_trim_left(curr);
-	_extcss3_trim_right(curr, last);
+	_extcss3_trim_left(intern, curr);
+	_extcss3_trim_right(intern, curr, last);
 }
 
 /* ==================================================================================================== */
 
-static inline void _extcss3_remove_token(extcss3_token **base, extcss3_token **token, extcss3_token *repl)
+static inline void _extcss3_remove_token(extcss3_intern *intern, extcss3_token **base, extcss3_token **token, extcss3_token *repl)
 {
 	if ((base != NULL) && (*base == *token)) {
-		*base = (*token)->next;
+		*base = EXTCSS3_TOKEN_NEXT(intern, *token);
 	}
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-	if ((*token)->next != NULL) {
-		(*token)->next->prev = (*token)->prev;
+	if ((*token)->next != 0) {
+		EXTCSS3_TOKEN_NEXT(intern, *token)->prev = (*token)->prev;
 	}
-	if ((*token)->prev != NULL) {
-		(*token)->prev->next = (*token)->next;
+	if ((*token)->prev != 0) {
+		EXTCSS3_TOKEN_PREV(intern, *token)->next = (*token)->next;
 	}
 
-	extcss3_release_token(*token);
-
 	*token = repl;
 }
 
@@ -870,138 +851,123 @@ static inline void _extcss3_remove_token(extcss3_token **base, extcss3_token **t
 
 static inline bool _extcss3_check_at_rule_is_valid_charset(extcss3_intern *intern, extcss3_rule *rule)
 {
+	extcss3_token *ws, *str, *semicolon;
+
 	if (
-		(rule->level == 0)														&&
-		(rule->base_selector->data.len == 8 /* strlen("@charset") */)			&&
-		(rule->base_selector->next)												&&
-		(rule->base_selector->next->type == EXTCSS3_TYPE_WS)					&&
-		(rule->base_selector->next->data.len == 1)								&&
-		(rule->base_selector->next->data.str[0] == ' ')							&&
-		(rule->base_selector->next->next)										&&
-		(rule->base_selector->next->next->type == EXTCSS3_TYPE_STRING)			&&
-		(rule->base_selector->next->next->data.str[0] == '"')					&&
-		(rule->base_selector->next->next->next)									&&
-		(rule->base_selector->next->next->next->type == EXTCSS3_TYPE_SEMICOLON)	&&
-		(rule->base_selector->data.str == intern->copy.str)						&&
-		(memcmp(rule->base_selector->data.str, "@charset", 8) == 0)
+		(rule->level == 0)																	&&
+		(rule->base_selector->data_off == 0)												&&
+		(EXTCSS3_TOKEN_KEYWORD(intern, rule->base_selector) == EXTCSS3_KEYWORD_AT_CHARSET)	&&
+		(memcmp(EXTCSS3_TOKEN_DATA(intern, rule->base_selector), "@charset", 8) == 0)
 	) {
-		return EXTCSS3_SUCCESS;
+		ws			= EXTCSS3_TOKEN_NEXT(intern, rule->base_selector);
+		str			= (ws != NULL) ? EXTCSS3_TOKEN_NEXT(intern, ws) : NULL;
+		semicolon	= (str != NULL) ? EXTCSS3_TOKEN_NEXT(intern, str) : NULL;
+
+		if (
+			(semicolon != NULL)											&&
+			(EXTCSS3_TOKEN_TYPE(intern, ws) == EXTCSS3_TYPE_WS)			&&
+			(ws->data_len == 1)											&&
+			(EXTCSS3_TOKEN_DATA(intern, ws)[0] == ' ')					&&
+			(EXTCSS3_TOKEN_TYPE(intern, str) == EXTCSS3_TYPE_STRING)	&&
+			(EXTCSS3_TOKEN_DATA(intern, str)[0] == '"')					&&
+			(EXTCSS3_TOKEN_TYPE(intern, semicolon) == EXTCSS3_TYPE_SEMICOLON)
+		) {
+			return EXTCSS3_SUCCESS;
+		}
 	}
 
 	return EXTCSS3_FAILURE;
 }
 
-static inline bool _extcss3_check_at_rule_is_valid_import(extcss3_rule *rule)
+static inline bool _extcss3_check_at_rule_is_valid_import(extcss3_intern *intern, extcss3_rule *rule)
 {
 	extcss3_rule *prev = rule->prev;
 
-	while ((prev != NULL) && _EXTCSS3_TYPE_EMPTY(prev->base_selector->type)) {
+	while ((prev != NULL) && _EXTCSS3_TYPE_EMPTY(EXTCSS3_TOKEN_TYPE(intern, prev->base_selector))) {
 		prev = prev->prev;
 	}
 
 	if (rule->level != 0) {
 		return EXTCSS3_FAILURE;
 	} else if (prev != NULL) {
-		if (
-			(prev->base_selector->data.len == 7 /* strlen("@import") */) &&
-			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(prev->base_selector->data.str, "@import", 7))
-		) {
-			// Do nothing. The previous "@import" was already checked.
-		} else if (
-			(prev->base_selector->data.len == 8 /* strlen("@charset") */) &&
-			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(prev->base_selector->data.str, "@charset", 8))
-		) {
-			// Do nothing. The previous "@charset" was already checked.
-		} else {
-			return EXTCSS3_FAILURE;
+		switch (EXTCSS3_TOKEN_KEYWORD(intern, prev->base_selector)) {
+			case EXTCSS3_KEYWORD_AT_IMPORT:
+			case EXTCSS3_KEYWORD_AT_CHARSET:
+				break; // Do nothing. The previous "@import" or "@charset" was already checked.
+			default:
+				return EXTCSS3_FAILURE;
 		}
 	}
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-	if (
-		(rule->base_selector->data.len == 7) &&
-		(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(rule->base_selector->data.str, "@import", 7))
-	) {
+	if (EXTCSS3_TOKEN_KEYWORD(intern, rule->base_selector) == EXTCSS3_KEYWORD_AT_IMPORT) {
 		return EXTCSS3_SUCCESS;
 	}
 
 	return EXTCSS3_FAILURE;
 }
 
-static inline bool _extcss3_check_at_rule_is_valid_namespace(extcss3_rule *rule)
+static inline bool _extcss3_check_at_rule_is_valid_namespace(extcss3_intern *intern, extcss3_rule *rule)
 {
 	extcss3_rule *prev = rule->prev;
 
-	while ((prev != NULL) && _EXTCSS3_TYPE_EMPTY(prev->base_selector->type)) {
+	while ((prev != NULL) && _EXTCSS3_TYPE_EMPTY(EXTCSS3_TOKEN_TYPE(intern, prev->base_selector))) {
 		prev = prev->prev;
 	}
 
 	if (rule->level != 0) {
 		return EXTCSS3_FAILURE;
 	} else if (prev != NULL) {
-		if (
-			(prev->base_selector->data.len == 10 /* strlen("@namespace") */) &&
-			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(prev->base_selector->data.str, "@namespace", 10))
-		) {
-			// Do nothing. The previous "@namespace" was already checked.
-		} else if (
-			(prev->base_selector->data.len == 7 /* strlen("@import") */) &&
-			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(prev->base_selector->data.str, "@import", 7))
-		) {
-			// Do nothing. The previous "@import" was already checked.
-		} else if (
-			(prev->base_selector->data.len == 8 /* strlen("@charset") */) &&
-			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(prev->base_selector->data.str, "@charset", 8))
-		) {
-			// Do nothing. The previous "@charset" was already checked.
-		} else {
-			return EXTCSS3_FAILURE;
+		switch (EXTCSS3_TOKEN_KEYWORD(intern, prev->base_selector)) {
+			case EXTCSS3_KEYWORD_AT_NAMESPACE:
+			case EXTCSS3_KEYWORD_AT_IMPORT:
+			case EXTCSS3_KEYWORD_AT_CHARSET:
+				break; // Do nothing. The previous "@namespace", "@import" or "@charset" was already checked.
+			default:
+				return EXTCSS3_FAILURE;
 		}
 	}
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-	if (
-		(rule->base_selector->data.len == 10) &&
-		(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(rule->base_selector->data.str, "@namespace", 10))
-	) {
+	if (EXTCSS3_TOKEN_KEYWORD(intern, rule->base_selector) == EXTCSS3_KEYWORD_AT_NAMESPACE) {
 		return EXTCSS3_SUCCESS;
 	}
 
 	return EXTCSS3_FAILURE;
 }
 
-static inline bool _extcss3_check_minify_color(extcss3_token *name, extcss3_token *value)
+static inline bool _extcss3_check_minify_color(extcss3_intern *intern, extcss3_token *name, extcss3_token *value)
 {
 	if (
-		(name->data.len >= 10)				&&
-		(value->user.str == NULL)			&&
-		(value->type == EXTCSS3_TYPE_IDENT)	&&
-		(value->data.len > 4)				&&
+		(name->data_len >= 10)										&&
+		(value->user_off == 0)										&&
+		(EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_IDENT)	&&
+		(value->data_len > 4)										&&
 		(
-			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(name->data.str + name->data.len - 10, "background", 10)) ||
-			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(name->data.str + name->data.len - 10, "decoration", 10))
+			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(EXTCSS3_TOKEN_DATA(intern, name) + name->data_len - 10, "background", 10)) ||
+			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(EXTCSS3_TOKEN_DATA(intern, name) + name->data_len - 10, "decoration", 10))
 		)
 	) {
 		return EXTCSS3_SUCCESS;
 	} else if (
-		(name->data.len >= 6)				&&
-		(value->user.str == NULL)			&&
-		(value->type == EXTCSS3_TYPE_IDENT)	&&
-		(value->data.len > 4)				&&
+		(name->data_len >= 6)										&&
+		(value->user_off == 0)										&&
+		(EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_IDENT)	&&
+		(value->data_len > 4)										&&
 		(
-			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(name->data.str + name->data.len - 6, "shadow", 6)) ||
-			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(name->data.str + name->data.len - 6, "filter", 6))
+			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(EXTCSS3_TOKEN_DATA(intern, name) + name->data_len - 6, "shadow", 6)) ||
+			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(EXTCSS3_TOKEN_DATA(intern, name) + name->data_len - 6, "filter", 6))
 		)
 	) {
 		return EXTCSS3_SUCCESS;
 	} else if (
-		(name->data.len >= 5)				&&
-		(value->user.str == NULL)			&&
-		(value->type == EXTCSS3_TYPE_IDENT)	&&
-		(value->data.len > 4)				&&
-		(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(name->data.str + name->data.len - 5, "color", 5))
+		(name->data_len >= 5)										&&
+		(value->user_off == 0)										&&
+		(EXTCSS3_TOKEN_TYPE(intern, value) == EXTCSS3_TYPE_IDENT)	&&
+		(value->data_len > 4)										&&
+		(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(EXTCSS3_TOKEN_DATA(intern, name) + name->data_len - 5, "color", 5))
 	) {
 		return EXTCSS3_SUCCESS;
 	}
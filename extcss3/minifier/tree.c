@@ -4,24 +4,27 @@
 
 /* ==================================================================================================== */
 
-static void *_extcss3_set_error_code(unsigned int *error, unsigned int code, extcss3_rule *tree);
+static void *_extcss3_set_error_code(unsigned int *error, unsigned int code);
 
-static bool _extcss3_tree_fork_rule(extcss3_rule **rule, unsigned int *error);
-static bool _extcss3_tree_fork_decl(extcss3_decl **decl, unsigned int *error);
+static uint32_t _extcss3_tree_find_block_end(extcss3_intern *intern, uint32_t index, unsigned int *nested);
+
+static bool _extcss3_tree_fork_rule(extcss3_intern *intern, extcss3_rule **rule, unsigned int *error);
+static bool _extcss3_tree_fork_decl(extcss3_intern *intern, extcss3_decl **decl, unsigned int *error);
 
 /* ==================================================================================================== */
 
-extcss3_rule *extcss3_create_tree(extcss3_token **token, extcss3_token *max, unsigned int level, unsigned int *error)
+extcss3_rule *extcss3_create_tree(extcss3_intern *intern, extcss3_token **token, extcss3_token *max, unsigned int level, unsigned int *error)
 {
 	extcss3_token *search;
 	extcss3_rule *tree, *rule;
+	uint32_t index;
 	extcss3_decl *decl, *last;
-	unsigned int levels, nested;
+	unsigned int nested;
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-	if ((tree = rule = extcss3_create_rule()) == NULL) {
-		return _extcss3_set_error_code(error, EXTCSS3_ERR_MEMORY, tree);
+	if ((tree = rule = extcss3_create_rule(intern)) == NULL) {
+		return _extcss3_set_error_code(error, EXTCSS3_ERR_MEMORY);
 	}
 
 	rule->level = level;
@@ -32,39 +35,26 @@ extcss3_rule *extcss3_create_tree(extcss3_token **token, extcss3_token *max, uns
 		// Every new rule initially has no "base_selector"
 		if (rule->base_selector == NULL) {
 			// Pseudo-rule for <commment> tokens that contain user strings
-			if (((*token)->type == EXTCSS3_TYPE_COMMENT) && ((*token)->user.str != NULL)) {
+			if ((EXTCSS3_TOKEN_TYPE(intern, *token) == EXTCSS3_TYPE_COMMENT) && ((*token)->user_off != 0)) {
 				rule->base_selector = rule->last_selector = *token;
 
 				// Fork the next rule
-				if (EXTCSS3_SUCCESS != _extcss3_tree_fork_rule(&rule, error)) {
-					return _extcss3_set_error_code(error, *error, tree);
+				if (EXTCSS3_SUCCESS != _extcss3_tree_fork_rule(intern, &rule, error)) {
+					return _extcss3_set_error_code(error, *error);
 				}
 
-				*token = (*token)->next;
+				*token = EXTCSS3_TOKEN_NEXT(intern, *token);
 
 				continue;
 			}
 			// Consume an invalid {}-block without selectors
-			else if ((*token)->type == EXTCSS3_TYPE_BR_CO) {
-				// Consume the '{'
-				*token = (*token)->next;
-
-				levels = 1;
-
-				while ((*token)->type != EXTCSS3_TYPE_EOF) {
-					if ((*token)->type == EXTCSS3_TYPE_BR_CO) {
-						levels++;
-					} else if ((*token)->type == EXTCSS3_TYPE_BR_CC) {
-						levels--;
-					}
-
-					if (levels == 0) {
-						// Consume the '}'
-						*token = (*token)->next;
-						break;
-					}
+			else if (EXTCSS3_TOKEN_TYPE(intern, *token) == EXTCSS3_TYPE_BR_CO) {
+				// Consume the '{' and everything up to the matching '}'
+				*token = EXTCSS3_TOKEN(intern, _extcss3_tree_find_block_end(intern, EXTCSS3_TOKEN_INDEX(intern, *token), &nested));
 
-					*token = (*token)->next;
+				if (EXTCSS3_TOKEN_TYPE(intern, *token) != EXTCSS3_TYPE_EOF) {
+					// Consume the '}'
+					*token = EXTCSS3_TOKEN_NEXT(intern, *token);
 				}
 
 				if ((*token == max)) {
@@ -73,67 +63,55 @@ extcss3_rule *extcss3_create_tree(extcss3_token **token, extcss3_token *max, uns
 			}
 
 			// Pseudo-rule for the <eof> token
-			if ((*token)->type == EXTCSS3_TYPE_EOF) {
+			if (EXTCSS3_TOKEN_TYPE(intern, *token) == EXTCSS3_TYPE_EOF) {
 				rule->base_selector = rule->last_selector = *token;
 				break;
 			}
 			// Beginn a new rule by a valid selector type
 			else if (
-				((*token)->type == EXTCSS3_TYPE_AT_KEYWORD)	||
-				((*token)->type == EXTCSS3_TYPE_IDENT)		||
-				((*token)->type == EXTCSS3_TYPE_HASH)		||
-				((*token)->type == EXTCSS3_TYPE_DELIM)		||
-				((*token)->type == EXTCSS3_TYPE_BR_SO)		||
-				((*token)->type == EXTCSS3_TYPE_COLON)		||
-				((*token)->type == EXTCSS3_TYPE_PERCENTAGE)
+				(EXTCSS3_TOKEN_TYPE(intern, *token) == EXTCSS3_TYPE_AT_KEYWORD)	||
+				(EXTCSS3_TOKEN_TYPE(intern, *token) == EXTCSS3_TYPE_IDENT)		||
+				(EXTCSS3_TOKEN_TYPE(intern, *token) == EXTCSS3_TYPE_HASH)		||
+				(EXTCSS3_TOKEN_TYPE(intern, *token) == EXTCSS3_TYPE_DELIM)		||
+				(EXTCSS3_TOKEN_TYPE(intern, *token) == EXTCSS3_TYPE_BR_SO)		||
+				(EXTCSS3_TOKEN_TYPE(intern, *token) == EXTCSS3_TYPE_COLON)		||
+				(EXTCSS3_TOKEN_TYPE(intern, *token) == EXTCSS3_TYPE_PERCENTAGE)
 			) {
 				rule->base_selector = rule->last_selector = *token;
-			} else if ((*token)->type != EXTCSS3_TYPE_WS && (*token)->type != EXTCSS3_TYPE_COMMENT) {
-				// Skip all tokens until the next '{'
+			} else if (EXTCSS3_TOKEN_TYPE(intern, *token) != EXTCSS3_TYPE_WS && EXTCSS3_TOKEN_TYPE(intern, *token) != EXTCSS3_TYPE_COMMENT) {
+				// Skip all tokens until the next '{' (a <eof> token terminates the type array)
+				index = EXTCSS3_TOKEN_INDEX(intern, *token);
+
 				while (
-					(*token != NULL) &&
-					((*token)->type != EXTCSS3_TYPE_EOF) &&
-					((*token)->type != EXTCSS3_TYPE_BR_CO)
+					(intern->types[index] != EXTCSS3_TYPE_EOF) &&
+					(intern->types[index] != EXTCSS3_TYPE_BR_CO)
 				) {
-					*token = (*token)->next;
+					index++;
 				}
 
+				*token = EXTCSS3_TOKEN(intern, index);
+
 				// The block is consumed as "invalid" block
 				continue;
 			}
 		} else {
 			// Consume a {}-block
-			if ((*token)->type == EXTCSS3_TYPE_BR_CO) {
+			if (EXTCSS3_TOKEN_TYPE(intern, *token) == EXTCSS3_TYPE_BR_CO) {
 				// Look forward for nested or unbalanced {}-blocks
-				levels = 1, nested = 0;
-				search = (*token)->next;
-
-				while (search->type != EXTCSS3_TYPE_EOF) {
-					if (search->type == EXTCSS3_TYPE_BR_CO) {
-						levels++;
-						nested++;
-					} else if (search->type == EXTCSS3_TYPE_BR_CC) {
-						levels--;
-					}
-
-					if (levels == 0) {
-						break;
-					}
-
-					search = search->next;
-				}
+				nested = 0;
+				search = EXTCSS3_TOKEN(intern, _extcss3_tree_find_block_end(intern, EXTCSS3_TOKEN_INDEX(intern, *token), &nested));
 
 				/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 				// Unbalanced {}-block detected
-				if (levels != 0) {
+				if (EXTCSS3_TOKEN_TYPE(intern, search) == EXTCSS3_TYPE_EOF) {
 					// Consume all tokens inside the unbalanced area
 					while (*token != search) {
-						*token = (*token)->next;
+						*token = EXTCSS3_TOKEN_NEXT(intern, *token);
 					}
 				} else {
-					if ((rule->block = extcss3_create_block()) == NULL) {
-						return _extcss3_set_error_code(error, EXTCSS3_ERR_MEMORY, tree);
+					if ((rule->block = extcss3_create_block(intern)) == NULL) {
+						return _extcss3_set_error_code(error, EXTCSS3_ERR_MEMORY);
 					}
 
 					// Set the '{'
@@ -142,14 +120,14 @@ extcss3_rule *extcss3_create_tree(extcss3_token **token, extcss3_token *max, uns
 					rule->block->last = search;
 
 					// Consume the '{'
-					*token = (*token)->next;
+					*token = EXTCSS3_TOKEN_NEXT(intern, *token);
 
 					/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 					// Consume all nested rules (recursive)
 					if (nested > 0) {
-						if ((rule->block->rules = extcss3_create_tree(token, search, level + 1, error)) == NULL) {
-							return _extcss3_set_error_code(error, *error, tree);
+						if ((rule->block->rules = extcss3_create_tree(intern, token, search, level + 1, error)) == NULL) {
+							return _extcss3_set_error_code(error, *error);
 						}
 					}
 					// Consume all declarations in the current block
@@ -159,18 +137,18 @@ extcss3_rule *extcss3_create_tree(extcss3_token **token, extcss3_token *max, uns
 						while (*token != search) {
 							if (decl == NULL) {
 								// Skip leading whitespace and comment tokens (unless they contain user strings)
-								if (_EXTCSS3_TYPE_EMPTY_EX(*token)) {
-									*token = (*token)->next;
+								if (_EXTCSS3_TYPE_EMPTY_EX(intern, *token)) {
+									*token = EXTCSS3_TOKEN_NEXT(intern, *token);
 									continue;
 								}
 
 								if (last == NULL) {
-									if ((rule->block->decls = decl = last = extcss3_create_decl()) == NULL) {
-										return _extcss3_set_error_code(error, EXTCSS3_ERR_MEMORY, tree);
+									if ((rule->block->decls = decl = last = extcss3_create_decl(intern)) == NULL) {
+										return _extcss3_set_error_code(error, EXTCSS3_ERR_MEMORY);
 									}
 								} else {
-									if (EXTCSS3_SUCCESS != _extcss3_tree_fork_decl(&last, error)) {
-										return _extcss3_set_error_code(error, *error, tree);
+									if (EXTCSS3_SUCCESS != _extcss3_tree_fork_decl(intern, &last, error)) {
+										return _extcss3_set_error_code(error, *error);
 									}
 
 									decl = last;
@@ -182,31 +160,31 @@ extcss3_rule *extcss3_create_tree(extcss3_token **token, extcss3_token *max, uns
 							// Update the last declaration token
 							decl->last = *token;
 
-							if ((*token)->type == EXTCSS3_TYPE_SEMICOLON) {
+							if (EXTCSS3_TOKEN_TYPE(intern, *token) == EXTCSS3_TYPE_SEMICOLON) {
 								decl = NULL;
 							}
 
-							*token = (*token)->next;
+							*token = EXTCSS3_TOKEN_NEXT(intern, *token);
 						}
 					}
 
 					// Fork the next rule
-					if (EXTCSS3_SUCCESS != _extcss3_tree_fork_rule(&rule, error)) {
-						return _extcss3_set_error_code(error, *error, tree);
+					if (EXTCSS3_SUCCESS != _extcss3_tree_fork_rule(intern, &rule, error)) {
+						return _extcss3_set_error_code(error, *error);
 					}
 				}
 
 				// Pseudo-rule for the <eof> token
-				if ((*token)->type == EXTCSS3_TYPE_EOF) {
+				if (EXTCSS3_TOKEN_TYPE(intern, *token) == EXTCSS3_TYPE_EOF) {
 					rule->base_selector = rule->last_selector = *token;
 					break;
 				}
 			} else {
 				// Pseudo-rule for the <eof> token
-				if ((*token)->type == EXTCSS3_TYPE_EOF) {
+				if (EXTCSS3_TOKEN_TYPE(intern, *token) == EXTCSS3_TYPE_EOF) {
 					// Fork the next rule
-					if (EXTCSS3_SUCCESS != _extcss3_tree_fork_rule(&rule, error)) {
-						return _extcss3_set_error_code(error, *error, tree);
+					if (EXTCSS3_SUCCESS != _extcss3_tree_fork_rule(intern, &rule, error)) {
+						return _extcss3_set_error_code(error, *error);
 					}
 
 					rule->base_selector = rule->last_selector = *token;
@@ -218,17 +196,17 @@ extcss3_rule *extcss3_create_tree(extcss3_token **token, extcss3_token *max, uns
 
 				// Close the current <at> rule and fork the next rule
 				if (
-					rule->base_selector->type == EXTCSS3_TYPE_AT_KEYWORD &&
-					(*token)->type == EXTCSS3_TYPE_SEMICOLON
+					EXTCSS3_TOKEN_TYPE(intern, rule->base_selector) == EXTCSS3_TYPE_AT_KEYWORD &&
+					EXTCSS3_TOKEN_TYPE(intern, *token) == EXTCSS3_TYPE_SEMICOLON
 				) {
-					if (EXTCSS3_SUCCESS != _extcss3_tree_fork_rule(&rule, error)) {
-						return _extcss3_set_error_code(error, *error, tree);
+					if (EXTCSS3_SUCCESS != _extcss3_tree_fork_rule(intern, &rule, error)) {
+						return _extcss3_set_error_code(error, *error);
 					}
 				}
 			}
 		}
 
-		*token = (*token)->next;
+		*token = EXTCSS3_TOKEN_NEXT(intern, *token);
 	}
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
@@ -238,22 +216,40 @@ extcss3_rule *extcss3_create_tree(extcss3_token **token, extcss3_token *max, uns
 
 /* ==================================================================================================== */
 
-static inline void *_extcss3_set_error_code(unsigned int *error, unsigned int code, extcss3_rule *tree)
+static inline void *_extcss3_set_error_code(unsigned int *error, unsigned int code)
 {
 	*error = code;
 
-	if (tree != NULL) {
-		extcss3_release_rules_list(tree);
+	return NULL;
+}
+
+/**
+ * Find the '}' of the {}-block opened by the '{' at the given index, or the <eof> token for an unbalanced block.
+ * The tree is built before any token is unlinked, so the token array is still in stream order and the scan can
+ * run over the dense type array instead of following the links.
+ */
+static inline uint32_t _extcss3_tree_find_block_end(extcss3_intern *intern, uint32_t index, unsigned int *nested)
+{
+	const uint8_t *types = intern->types;
+	unsigned int levels = 1;
+
+	for (index++; types[index] != EXTCSS3_TYPE_EOF; index++) {
+		if (types[index] == EXTCSS3_TYPE_BR_CO) {
+			levels++;
+			(*nested)++;
+		} else if ((types[index] == EXTCSS3_TYPE_BR_CC) && (--levels == 0)) {
+			break;
+		}
 	}
 
-	return NULL;
+	return index;
 }
 
-static inline bool _extcss3_tree_fork_rule(extcss3_rule **rule, unsigned int *error)
+static inline bool _extcss3_tree_fork_rule(extcss3_intern *intern, extcss3_rule **rule, unsigned int *error)
 {
 	extcss3_rule *fork;
 
-	if ((fork = extcss3_create_rule()) == NULL) {
+	if ((fork = extcss3_create_rule(intern)) == NULL) {
 		*error = EXTCSS3_ERR_MEMORY;
 		return EXTCSS3_FAILURE;
 	}
@@ -266,11 +262,11 @@ static inline bool _extcss3_tree_fork_rule(extcss3_rule **rule, unsigned int *er
 	return EXTCSS3_SUCCESS;
 }
 
-static inline bool _extcss3_tree_fork_decl(extcss3_decl **decl, unsigned int *error)
+static inline bool _extcss3_tree_fork_decl(extcss3_intern *intern, extcss3_decl **decl, unsigned int *error)
 {
 	extcss3_decl *fork;
 
-	if ((fork = extcss3_create_decl()) == NULL) {
+	if ((fork = extcss3_create_decl(intern)) == NULL) {
 		*error = EXTCSS3_ERR_MEMORY;
 		return EXTCSS3_FAILURE;
 	}
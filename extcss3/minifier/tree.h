@@ -5,6 +5,6 @@
 
 /* ==================================================================================================== */
 
-extcss3_rule *extcss3_create_tree(extcss3_token **token, extcss3_token *max, unsigned int level, unsigned int *error);
+extcss3_rule *extcss3_create_tree(extcss3_intern *intern, extcss3_token **token, extcss3_token *max, unsigned int level, unsigned int *error);
 
 #endif /* EXTCSS3_MINIFIER_TREE_H */
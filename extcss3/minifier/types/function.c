@@ -1,6 +1,7 @@
 #include "function.h"
 #include "hash.h"
 #include "../../intern.h"
+#include "../../number.h"
 #include "../../utils.h"
 
 #include <math.h>
@@ -9,9 +10,11 @@
 
 /* ==================================================================================================== */
 
-bool extcss3_minify_function_rgb_a(extcss3_token **token, extcss3_decl *decl, unsigned int *error)
+bool extcss3_minify_function_rgb_a(extcss3_intern *intern, extcss3_token **token, extcss3_decl *decl, unsigned int *error)
 {
-	extcss3_token *temp, *curr = (*token)->next;
+	extcss3_token *temp, *spare = NULL, *curr = EXTCSS3_TOKEN_NEXT(intern, *token);
+	extcss3_number *number;
+	char *user;
 	double value;
 	char hex[9];
 	unsigned int idx = 0, percentages = 0, numbers = 0;
@@ -19,27 +22,29 @@ bool extcss3_minify_function_rgb_a(extcss3_token **token, extcss3_decl *decl, un
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-	while ((curr->next != NULL) && (curr->type != EXTCSS3_TYPE_BR_RC)) {
-		if ((curr->type == EXTCSS3_TYPE_NUMBER) || (curr->type == EXTCSS3_TYPE_PERCENTAGE)) {
-			if (!valid || (((*token)->data.len == 3) && (idx > 4)) || (((*token)->data.len == 4) && (idx > 6))) {
+	while ((curr->next != 0) && (EXTCSS3_TOKEN_TYPE(intern, curr) != EXTCSS3_TYPE_BR_RC)) {
+		if ((EXTCSS3_TOKEN_TYPE(intern, curr) == EXTCSS3_TYPE_NUMBER) || (EXTCSS3_TOKEN_TYPE(intern, curr) == EXTCSS3_TYPE_PERCENTAGE)) {
+			if (!valid || (((*token)->data_len == 3) && (idx > 4)) || (((*token)->data_len == 4) && (idx > 6))) {
 				return EXTCSS3_FAILURE; // Too many values
+			} else if ((number = EXTCSS3_TOKEN_NUMBER(intern, curr)) == NULL) {
+				return EXTCSS3_SUCCESS; // The number was not kept, leave the function as it is
 			}
 
-			value = atof(curr->data.str);
+			value = extcss3_number_to_double(number);
 
 			if (value < 0) {
 				return EXTCSS3_FAILURE; // Invalid value: 0 - 255
-			} else if ((curr->type == EXTCSS3_TYPE_NUMBER) && (value > 255)) {
+			} else if ((EXTCSS3_TOKEN_TYPE(intern, curr) == EXTCSS3_TYPE_NUMBER) && (value > 255)) {
 				return EXTCSS3_FAILURE; // Invalid value: 0 - 255
-			} else if ((curr->type == EXTCSS3_TYPE_PERCENTAGE) && (value > 100)) {
+			} else if ((EXTCSS3_TOKEN_TYPE(intern, curr) == EXTCSS3_TYPE_PERCENTAGE) && (value > 100)) {
 				return EXTCSS3_FAILURE; // Invalid value: 0% - 100%
-			} else if ((idx > 4) && (curr->type == EXTCSS3_TYPE_NUMBER) && ((int)value > 1)) {
+			} else if ((idx > 4) && (EXTCSS3_TOKEN_TYPE(intern, curr) == EXTCSS3_TYPE_NUMBER) && ((int)value > 1)) {
 				return EXTCSS3_FAILURE; // Invalid value: 0 - 1
 			} else if ((idx < 6) && ((int)value != value)) {
 				return EXTCSS3_FAILURE; // Invalid value: 0 - 1
 			}
 
-			if (curr->type == EXTCSS3_TYPE_PERCENTAGE) {
+			if (EXTCSS3_TOKEN_TYPE(intern, curr) == EXTCSS3_TYPE_PERCENTAGE) {
 				value = roundf(value * 2.55);
 
 				percentages++;
@@ -59,10 +64,10 @@ bool extcss3_minify_function_rgb_a(extcss3_token **token, extcss3_decl *decl, un
 			idx += 2;
 
 			valid = false;
-		} else if (!_EXTCSS3_TYPE_EMPTY(curr->type)) {
+		} else if (!_EXTCSS3_TYPE_EMPTY(EXTCSS3_TOKEN_TYPE(intern, curr))) {
 			if (valid) {
 				return EXTCSS3_FAILURE;
-			} else if (curr->type == EXTCSS3_TYPE_COMMA) {
+			} else if (EXTCSS3_TOKEN_TYPE(intern, curr) == EXTCSS3_TYPE_COMMA) {
 				valid = true;
 			}
 		}
@@ -71,62 +76,56 @@ bool extcss3_minify_function_rgb_a(extcss3_token **token, extcss3_decl *decl, un
 			break;
 		}
 
-		curr = curr->next;
+		curr = EXTCSS3_TOKEN_NEXT(intern, curr);
 	}
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-	if ((((*token)->data.len == 3) && (idx == 6)) || (((*token)->data.len == 4) && (idx == 8))) {
-		if (EXTCSS3_SUCCESS != extcss3_minify_hash(hex, idx, *token, error)) {
+	if ((((*token)->data_len == 3) && (idx == 6)) || (((*token)->data_len == 4) && (idx == 8))) {
+		if (EXTCSS3_SUCCESS != extcss3_minify_hash(intern, hex, idx, *token, error)) {
 			return EXTCSS3_FAILURE;
 		}
 
 		// There was nothing to do for the extcss3_minify_hash() function
-		if ((*token)->user.str == NULL) {
-			(*token)->user.len = idx + 1;
-
-			if (((*token)->user.str = (char *)calloc((*token)->user.len, sizeof(char))) == NULL) {
+		if ((*token)->user_off == 0) {
+			if ((user = extcss3_create_user_str(intern, *token, idx + 1)) == NULL) {
 				*error = EXTCSS3_ERR_MEMORY;
 				return EXTCSS3_FAILURE;
 			}
 
-			(*token)->user.str[0] = '#';
-			memcpy((*token)->user.str + 1, hex, idx);
+			user[0] = '#';
+			memcpy(user + 1, hex, idx);
 		}
 
-		(*token)->type = EXTCSS3_TYPE_HASH;
+		EXTCSS3_TOKEN_TYPE(intern, *token) = EXTCSS3_TYPE_HASH;
 
+		// Remove the arguments and the ')', the removed token next to the '(' remains in "spare"
 		while (curr != *token) {
 			if (curr == decl->last) {
-				decl->last = curr->prev;
+				decl->last = EXTCSS3_TOKEN_PREV(intern, curr);
 			}
 
-			curr->next->prev = curr->prev;
-			curr->prev->next = curr->next;
+			EXTCSS3_TOKEN_NEXT(intern, curr)->prev = curr->prev;
+			EXTCSS3_TOKEN_PREV(intern, curr)->next = curr->next;
 
-			temp = curr->prev;
-			extcss3_release_token(curr);
-			curr = temp;
+			spare = curr;
+			curr = EXTCSS3_TOKEN_PREV(intern, curr);
 		}
 
-		if ((*token != decl->last) && ((*token)->next != decl->last) && !_EXTCSS3_TYPE_EMPTY((*token)->next->type)) {
-			temp = (*token)->next;
+		temp = EXTCSS3_TOKEN_NEXT(intern, *token);
 
-			// Create a new whitespace token
-			if (((*token)->next = extcss3_create_token()) == NULL) {
-				extcss3_release_tokens_list(temp);
+		if ((*token != decl->last) && (temp != decl->last) && !_EXTCSS3_TYPE_EMPTY(EXTCSS3_TOKEN_TYPE(intern, temp))) {
+			// Reuse the removed token as the new whitespace token
+			memset(spare, 0, sizeof(extcss3_token));
 
-				*error = EXTCSS3_ERR_MEMORY;
-				return EXTCSS3_FAILURE;
-			}
+			EXTCSS3_TOKEN_TYPE(intern, spare) = EXTCSS3_TYPE_WS;
+			spare->prev = EXTCSS3_TOKEN_INDEX(intern, *token);
+			spare->next = EXTCSS3_TOKEN_INDEX(intern, temp);
 
-			(*token)->next->type = EXTCSS3_TYPE_WS;
-			(*token)->next->prev = (*token);
-			(*token)->next->next = temp;
-			temp->prev = (*token)->next;
+			(*token)->next = temp->prev = EXTCSS3_TOKEN_INDEX(intern, spare);
 		}
 
-		*token = (*token)->next;
+		*token = EXTCSS3_TOKEN_NEXT(intern, *token);
 
 		return EXTCSS3_SUCCESS;
 	}
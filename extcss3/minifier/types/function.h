@@ -5,6 +5,6 @@
 
 /* ==================================================================================================== */
 
-bool extcss3_minify_function_rgb_a(extcss3_token **token, extcss3_decl *decl, unsigned int *error);
+bool extcss3_minify_function_rgb_a(extcss3_intern *intern, extcss3_token **token, extcss3_decl *decl, unsigned int *error);
 
 #endif /* EXTCSS3_MINIFIER_TYPES_FUNCTION_H */
@@ -1,4 +1,6 @@
 #include "numeric.h"
+#include "../../intern.h"
+#include "../../number.h"
 #include "../../utils.h"
 
 #include <string.h>
@@ -31,11 +33,11 @@ const char *extcss3_numeric_dimensions[19] = {
 	"turn"
 };
 
-static inline bool _extcss3_minify_numeric_preserve_dimension(extcss3_token *token)
+static inline bool _extcss3_minify_numeric_preserve_dimension(extcss3_intern *intern, extcss3_token *token)
 {
 	unsigned int i, elements;
 
-	if (token->type != EXTCSS3_TYPE_DIMENSION) {
+	if (EXTCSS3_TOKEN_TYPE(intern, token) != EXTCSS3_TYPE_DIMENSION) {
 		return EXTCSS3_FAILURE;
 	}
 
@@ -43,8 +45,8 @@ static inline bool _extcss3_minify_numeric_preserve_dimension(extcss3_token *tok
 
 	for (i = elements; i--; ) {
 		if (
-			(strlen(extcss3_numeric_dimensions[i]) == token->info.len) &&
-			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(token->info.str, extcss3_numeric_dimensions[i], token->info.len))
+			(strlen(extcss3_numeric_dimensions[i]) == token->info_len) &&
+			(EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(EXTCSS3_TOKEN_INFO(intern, token), extcss3_numeric_dimensions[i], token->info_len))
 		) {
 			return EXTCSS3_FAILURE;
 		}
@@ -53,109 +55,65 @@ static inline bool _extcss3_minify_numeric_preserve_dimension(extcss3_token *tok
 	return EXTCSS3_SUCCESS;
 }
 
+/**
+ * Check whether the unit would be read as the exponent behind a number, as "e5" or "e-5" (only possible for
+ * numbers given with an exponent, like "1e3e5")
+ */
+static inline bool _extcss3_minify_numeric_unit_is_exponent(const char *info, size_t info_len)
+{
+	if ((info_len < 2) || !EXTCSS3_CHARS_EQ(info[0], 'e')) {
+		return false;
+	} else if (EXTCSS3_IS_DIGIT(info[1])) {
+		return true;
+	}
+
+	return (info_len > 2) && ((info[1] == '+') || (info[1] == '-')) && EXTCSS3_IS_DIGIT(info[2]);
+}
+
 /* ==================================================================================================== */
 
-bool extcss3_minify_numeric(extcss3_token *token, bool preserve_sign, unsigned int *error)
+bool extcss3_minify_numeric(extcss3_intern *intern, extcss3_token *token, bool preserve_sign, unsigned int *error)
 {
-	char *base, *last;
-	double num;
-	unsigned int val_is_signed = 0;
+	extcss3_number *number;
+	char *info, *user, str[EXTCSS3_NUMBER_FORMAT_SIZE];
+	size_t len, info_len;
 
 	if (token == NULL) {
 		*error = EXTCSS3_ERR_NULL_PTR;
 		return EXTCSS3_FAILURE;
 	} else if (
-		(token->type != EXTCSS3_TYPE_NUMBER)		&&
-		(token->type != EXTCSS3_TYPE_PERCENTAGE)	&&
-		(token->type != EXTCSS3_TYPE_DIMENSION)
+		(EXTCSS3_TOKEN_TYPE(intern, token) != EXTCSS3_TYPE_NUMBER)		&&
+		(EXTCSS3_TOKEN_TYPE(intern, token) != EXTCSS3_TYPE_PERCENTAGE)	&&
+		(EXTCSS3_TOKEN_TYPE(intern, token) != EXTCSS3_TYPE_DIMENSION)
 	) {
 		return EXTCSS3_SUCCESS;
-	} else if (token->data.len <= 1) {
+	} else if (token->data_len <= 1) {
 		return EXTCSS3_SUCCESS; // No minifying potential
+	} else if (((number = EXTCSS3_TOKEN_NUMBER(intern, token)) == NULL) || number->inexact) {
+		return EXTCSS3_SUCCESS; // Keep the digits that do not fit into the parsed number (or were not kept at all)
 	}
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-	if ((num = atof(token->data.str)) == 0) {
-		if (preserve_sign && ((*token->data.str == '-') || (*token->data.str == '+'))) {
-			token->user.len = 1 + token->info.len + (int)preserve_sign;
-		} else {
-			token->user.len = 1 + token->info.len;
-		}
+	info = EXTCSS3_TOKEN_INFO(intern, token);
+	info_len = token->info_len;
 
-		if ((token->user.str = (char *)calloc(token->user.len + token->info.len, sizeof(char))) == NULL) {
-			*error = EXTCSS3_ERR_MEMORY;
-			return EXTCSS3_FAILURE;
-		}
-
-		if (preserve_sign && ((*token->data.str == '-') || (*token->data.str == '+'))) {
-			token->user.str[0] = *token->data.str;
-			token->user.str[0 + (int)preserve_sign] = '0';
-		} else {
-			*token->user.str = '0';
-		}
-	} else {
-		if ((*token->data.str == '-') || (preserve_sign && (*token->data.str == '+'))) {
-			val_is_signed = 1;
-		} else if (*token->data.str == '+') {
-			token->data.str++;
-			token->data.len--;
-		}
-
-		// Remove trailing and leading '0' digits
-		base = token->data.str + val_is_signed;
-		while (*base == '0') {
-			base++;
-		}
-
-		last = token->data.str + token->data.len - token->info.len;
-		while (last != base) {
-			if (*last == '.') {
-				break;
-			}
-			last--;
-		}
-
-		if (*last == '.') {
-			last = token->data.str + token->data.len - token->info.len;
-
-			while ((last-1)[0] == '0') {
-				last--;
-			}
-			if ((last-1)[0] == '.') {
-				last--;
-			}
-		} else {
-			last = token->data.str + token->data.len - token->info.len;
-		}
-
-		if (base == (token->data.str + val_is_signed)) {
-			if (last == (token->data.str + token->data.len - token->info.len)) {
-				return EXTCSS3_SUCCESS; // Nothing to do
-			}
-		}
-
-		token->user.len = last - base + val_is_signed + token->info.len;
-
-		if ((token->user.str = (char *)calloc(token->user.len, sizeof(char))) == NULL) {
-			*error = EXTCSS3_ERR_MEMORY;
-			return EXTCSS3_FAILURE;
-		}
-
-		if (val_is_signed > 0) {
-			*token->user.str = *token->data.str;
-		}
-
-		memcpy(token->user.str + val_is_signed, base, token->user.len - val_is_signed - token->info.len);
+	if ((number->mantissa == 0) && (EXTCSS3_SUCCESS != _extcss3_minify_numeric_preserve_dimension(intern, token))) {
+		info_len = 0;
 	}
 
-	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+	// A unit like "e5" would become the exponent of the number
+	len = extcss3_number_format(number, preserve_sign, _extcss3_minify_numeric_unit_is_exponent(info, info_len), str);
 
-	if ((num != 0) || (EXTCSS3_SUCCESS == _extcss3_minify_numeric_preserve_dimension(token))) {
-		memcpy(token->user.str + token->user.len - token->info.len, token->info.str, token->info.len);
-	} else if (token->user.str != NULL) {
-		token->user.len -= token->info.len;
+	if (!len || ((len + info_len) >= token->data_len)) {
+		return EXTCSS3_SUCCESS; // Nothing to do
+	} else if ((user = extcss3_create_user_str(intern, token, len + info_len)) == NULL) {
+		*error = EXTCSS3_ERR_MEMORY;
+		return EXTCSS3_FAILURE;
 	}
 
+	memcpy(user, str, len);
+	memcpy(user + len, info, info_len);
+
 	return EXTCSS3_SUCCESS;
 }
@@ -0,0 +1,194 @@
+#include "number.h"
+
+#include <math.h>
+
+/* ==================================================================================================== */
+
+/* The powers of ten that are exact doubles */
+static const double _extcss3_pow10[23] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* ==================================================================================================== */
+
+/**
+ * Add the next digit of the integer or fraction part. The "shift" counts the decimal places to move the
+ * digits of the mantissa, the leading '0' digits are skipped.
+ */
+void extcss3_number_add_digit(extcss3_number *number, char c, bool fraction, int64_t *shift)
+{
+	if (number->digits < EXTCSS3_NUMBER_DIGITS) {
+		if (number->digits || (c != '0')) {
+			number->mantissa = (number->mantissa * 10) + (uint64_t)(c - '0');
+			number->digits++;
+		}
+
+		if (fraction) {
+			(*shift)--;
+		}
+	} else {
+		if (!fraction) {
+			(*shift)++;
+		}
+
+		if (c != '0') {
+			number->inexact = true;
+		}
+	}
+}
+
+/**
+ * Set the exponent of the mantissa and remove the trailing '0' digits
+ */
+void extcss3_number_finish(extcss3_number *number, int64_t exponent)
+{
+	if (number->mantissa == 0) {
+		number->exponent = 0;
+		number->digits = 0;
+
+		return;
+	}
+
+	while ((number->mantissa % 10) == 0) {
+		number->mantissa /= 10;
+		number->digits--;
+		exponent++;
+	}
+
+	if (exponent > EXTCSS3_NUMBER_EXPONENT_MAX) {
+		exponent = EXTCSS3_NUMBER_EXPONENT_MAX;
+		number->inexact = true;
+	} else if (exponent < -EXTCSS3_NUMBER_EXPONENT_MAX) {
+		exponent = -EXTCSS3_NUMBER_EXPONENT_MAX;
+		number->inexact = true;
+	}
+
+	number->exponent = (int32_t)exponent;
+}
+
+/* ==================================================================================================== */
+
+double extcss3_number_to_double(const extcss3_number *number)
+{
+	double value = (double)number->mantissa;
+
+	// Both factors are exact for the usual numbers, so the result is rounded only once
+	if ((number->exponent >= 0) && (number->exponent <= 22)) {
+		value *= _extcss3_pow10[number->exponent];
+	} else if ((number->exponent < 0) && (number->exponent >= -22)) {
+		value /= _extcss3_pow10[-number->exponent];
+	} else {
+		value *= pow(10, number->exponent);
+	}
+
+	return (number->sign == '-') ? -value : value;
+}
+
+/**
+ * Write the shortest form of the number to "str" (EXTCSS3_NUMBER_FORMAT_SIZE bytes, no '\0'), returns 0 if
+ * the number does not fit.
+ *
+ * The plain form ("1000", "1.5" or ".05") is used, unless the exponent form ("1e3" or "15e-4") is shorter
+ * for a number that was given with an exponent, or "force_exponent" is given. The '+' sign is only kept
+ * with "preserve_sign", the '-' sign of zero too.
+ */
+size_t extcss3_number_format(const extcss3_number *number, bool preserve_sign, bool force_exponent, char *str)
+{
+	char digits[EXTCSS3_NUMBER_DIGITS + 1], exponent[12];
+	uint64_t mantissa = number->mantissa;
+	uint32_t value;
+	size_t i, len = 0, n = 0, e = 0, plain, point;
+
+	if ((number->sign == '-') && (mantissa || preserve_sign)) {
+		str[len++] = '-';
+	} else if ((number->sign == '+') && preserve_sign) {
+		str[len++] = '+';
+	}
+
+	if (mantissa == 0) {
+		str[len++] = '0';
+
+		// A unit like "e5" must not become the exponent of the number
+		if (force_exponent) {
+			str[len++] = 'e';
+			str[len++] = '0';
+		}
+
+		return len;
+	}
+
+	// The digits are written backwards
+	for (; mantissa; mantissa /= 10) {
+		digits[n++] = (char)('0' + (mantissa % 10));
+	}
+
+	value = (uint32_t)((number->exponent < 0) ? -(int64_t)number->exponent : number->exponent);
+
+	do {
+		exponent[e++] = (char)('0' + (value % 10));
+		value /= 10;
+	} while (value);
+
+	if (number->exponent < 0) {
+		exponent[e++] = '-';
+	}
+
+	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+	if (number->exponent >= 0) {
+		plain = n + (size_t)number->exponent;		// "1000"
+		point = 0;
+	} else if ((size_t)-number->exponent < n) {
+		plain = n + 1;								// "1.5"
+		point = (size_t)-number->exponent;
+	} else {
+		plain = 1 + (size_t)-number->exponent;		// ".05"
+		point = (size_t)-number->exponent;
+	}
+
+	if (force_exponent || (number->scientific && ((n + 1 + e) < plain))) {
+		// "15e-4"
+		for (i = n; i--; ) {
+			str[len++] = digits[i];
+		}
+
+		str[len++] = 'e';
+
+		for (i = e; i--; ) {
+			str[len++] = exponent[i];
+		}
+
+		return len;
+	} else if ((len + plain) > EXTCSS3_NUMBER_FORMAT_SIZE) {
+		return 0;
+	}
+
+	if (number->exponent >= 0) {
+		for (i = n; i--; ) {
+			str[len++] = digits[i];
+		}
+
+		for (i = number->exponent; i--; ) {
+			str[len++] = '0';
+		}
+	} else {
+		if (point >= n) {
+			str[len++] = '.';
+
+			for (i = point - n; i--; ) {
+				str[len++] = '0';
+			}
+		}
+
+		for (i = n; i--; ) {
+			str[len++] = digits[i];
+
+			if (i && (i == point)) {
+				str[len++] = '.';
+			}
+		}
+	}
+
+	return len;
+}
@@ -0,0 +1,27 @@
+#ifndef EXTCSS3_NUMBER_H
+#define EXTCSS3_NUMBER_H
+
+#include "types.h"
+
+/* ==================================================================================================== */
+
+/* Maximum number of significant digits of a number, further digits make the number inexact */
+#define EXTCSS3_NUMBER_DIGITS		((uint8_t)19)
+
+/* Maximum absolute decimal exponent of a number, larger exponents make the number inexact */
+#define EXTCSS3_NUMBER_EXPONENT_MAX	((int64_t)99999999)
+
+/* Size of the buffer for extcss3_number_format(), enough for the sign, the digits and the exponent */
+#define EXTCSS3_NUMBER_FORMAT_SIZE	((size_t)32)
+
+/* ==================================================================================================== */
+
+void extcss3_number_add_digit(extcss3_number *number, char c, bool fraction, int64_t *shift);
+void extcss3_number_finish(extcss3_number *number, int64_t exponent);
+
+double extcss3_number_to_double(const extcss3_number *number);
+size_t extcss3_number_format(const extcss3_number *number, bool preserve_sign, bool force_exponent, char *str);
+
+/* ==================================================================================================== */
+
+#endif /* EXTCSS3_NUMBER_H */
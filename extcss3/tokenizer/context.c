@@ -1,18 +1,69 @@
 #include "context.h"
+#include "../allocator.h"
 #include "../intern.h"
+#include "../utils.h"
+
+#include <stdlib.h>
 
 /* ==================================================================================================== */
 
+static inline bool _extcss3_ctxt_child(extcss3_intern *intern, unsigned int *error)
+{
+	extcss3_ctxt *base;
+	size_t level = intern->last_ctxt->level + 1;
+
+	// Grow the stack only if the nesting gets deeper than ever before
+	if (level >= intern->ctxt_size) {
+		if ((base = (extcss3_ctxt *)EXTCSS3_REALLOC(&intern->allocator, intern->base_ctxt, intern->ctxt_size * 2 * sizeof(extcss3_ctxt))) == NULL) {
+			*error = EXTCSS3_ERR_MEMORY;
+
+			return EXTCSS3_FAILURE;
+		}
+
+		intern->base_ctxt = base;
+		intern->ctxt_size *= 2;
+	}
+
+	intern->last_ctxt = intern->base_ctxt + level;
+	intern->last_ctxt->level = level;
+	intern->last_ctxt->token = EXTCSS3_TOKEN_INDEX(intern, intern->last_token);
+
+	return EXTCSS3_SUCCESS;
+}
+
 static inline void _extcss3_ctxt_parent(extcss3_intern *intern)
 {
-	extcss3_ctxt *prev;
+	if (intern->last_ctxt != intern->base_ctxt) {
+		intern->last_ctxt--;
+	}
+}
+
+/* ==================================================================================================== */
 
-	if ((intern->last_ctxt != NULL) && (intern->last_ctxt->prev != NULL)) {
-		prev = intern->last_ctxt->prev;
-		prev->next = NULL;
-		extcss3_release_ctxt(intern->last_ctxt);
-		intern->last_ctxt = prev;
+bool extcss3_ctxt_reset(extcss3_intern *intern, unsigned int *error)
+{
+	if (intern == NULL) {
+		*error = EXTCSS3_ERR_NULL_PTR;
+
+		return EXTCSS3_FAILURE;
+	}
+
+	// The stack is kept allocated for the following runs
+	if (intern->base_ctxt == NULL) {
+		if ((intern->base_ctxt = (extcss3_ctxt *)EXTCSS3_MALLOC(&intern->allocator, EXTCSS3_CTXT_SIZE * sizeof(extcss3_ctxt))) == NULL) {
+			*error = EXTCSS3_ERR_MEMORY;
+
+			return EXTCSS3_FAILURE;
+		}
+
+		intern->ctxt_size = EXTCSS3_CTXT_SIZE;
 	}
+
+	intern->last_ctxt = intern->base_ctxt;
+	intern->last_ctxt->level = 0;
+	intern->last_ctxt->token = 0;
+
+	return EXTCSS3_SUCCESS;
 }
 
 bool extcss3_ctxt_update(extcss3_intern *intern, unsigned int *error)
@@ -23,25 +74,14 @@ bool extcss3_ctxt_update(extcss3_intern *intern, unsigned int *error)
 		return EXTCSS3_FAILURE;
 	}
 
-	switch (intern->last_token->type) {
+	switch (EXTCSS3_TOKEN_TYPE(intern, intern->last_token)) {
 		case EXTCSS3_TYPE_AT_KEYWORD:
 		case EXTCSS3_TYPE_FUNCTION:
 		case EXTCSS3_TYPE_BR_RO:
 		case EXTCSS3_TYPE_BR_SO:
 		case EXTCSS3_TYPE_BR_CO:
 		{
-			if ((intern->last_ctxt->next = extcss3_create_ctxt()) == NULL) {
-				*error = EXTCSS3_ERR_MEMORY;
-
-				return EXTCSS3_FAILURE;
-			}
-
-			intern->last_ctxt->next->level = intern->last_ctxt->level + 1;
-			intern->last_ctxt->next->token = intern->last_token;
-			intern->last_ctxt->next->prev = intern->last_ctxt;
-			intern->last_ctxt = intern->last_ctxt->next;
-
-			break;
+			return _extcss3_ctxt_child(intern, error);
 		}
 		case EXTCSS3_TYPE_BR_RC:
 		case EXTCSS3_TYPE_BR_SC:
@@ -53,9 +93,9 @@ bool extcss3_ctxt_update(extcss3_intern *intern, unsigned int *error)
 		case EXTCSS3_TYPE_BR_CC:
 		{
 			if (
-				(intern->last_ctxt->prev != NULL) &&
-				(intern->last_ctxt->prev->token != NULL) &&
-				(intern->last_ctxt->prev->token->type == EXTCSS3_TYPE_AT_KEYWORD)
+				(intern->last_ctxt != intern->base_ctxt) &&
+				((intern->last_ctxt - 1)->token != 0) &&
+				(intern->types[(intern->last_ctxt - 1)->token] == EXTCSS3_TYPE_AT_KEYWORD)
 			) {
 				_extcss3_ctxt_parent(intern);
 				_extcss3_ctxt_parent(intern);
@@ -67,7 +107,7 @@ bool extcss3_ctxt_update(extcss3_intern *intern, unsigned int *error)
 		}
 		case EXTCSS3_TYPE_SEMICOLON:
 		{
-			if ((intern->last_ctxt->token != NULL) && (intern->last_ctxt->token->type == EXTCSS3_TYPE_AT_KEYWORD)) {
+			if ((intern->last_ctxt->token != 0) && (intern->types[intern->last_ctxt->token] == EXTCSS3_TYPE_AT_KEYWORD)) {
 				_extcss3_ctxt_parent(intern);
 			}
 
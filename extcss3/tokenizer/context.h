@@ -5,6 +5,12 @@
 
 /* ==================================================================================================== */
 
+/* Initial number of nesting levels of the context stack */
+#define EXTCSS3_CTXT_SIZE	32
+
+/* ==================================================================================================== */
+
+bool extcss3_ctxt_reset(extcss3_intern *intern, unsigned int *error);
 bool extcss3_ctxt_update(extcss3_intern *intern, unsigned int *error);
 
 #endif /* EXTCSS3_TOKENIZER_CONTEXT_H */
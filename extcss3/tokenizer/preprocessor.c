@@ -1,104 +1,380 @@
+#include "../intern.h"
 #include "../utils.h"
 #include "preprocessor.h"
 
 #include <string.h>
 
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+#if defined(EXTCSS3_HAVE_AVX2)
+# include <immintrin.h>
+#endif
+
 /* ==================================================================================================== */
 
 /**
- * Check the validity of the bytes in the non-ASCII (UTF-8) character
+ * Get the position of the first non-ASCII byte of the string, or "len" if there is none
  */
-static inline bool _extcss3_check_bytes_corruption(extcss3_intern *intern, unsigned int *error)
+static inline size_t _extcss3_find_non_ascii(const char *str, size_t len)
 {
-	unsigned int i, j;
+	size_t i = 0;
 
-	if (EXTCSS3_IS_NON_ASCII(*intern->state.cursor)) {
-		i = 7;
-		j = 0;
+#if defined(__SSE2__)
+	int mask;
 
-		while ((i >= 0) && ((*intern->state.cursor >> i) & 1)) {
-			if (j > intern->state.rest) {
-				*error = EXTCSS3_ERR_BYTES_CORRUPTION;
+	for (; (i + 16) <= len; i += 16) {
+		if ((mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(str + i)))) != 0) {
+			return i + __builtin_ctz(mask);
+		}
+	}
+#endif
 
-				return EXTCSS3_FAILURE;
-			}
+	for (; i < len; i++) {
+		if (EXTCSS3_IS_NON_ASCII(str[i])) {
+			break;
+		}
+	}
 
-			if (j && ((((intern->state.cursor[j] >> 7) & 1) != 1) || (((intern->state.cursor[j] >> 6) & 1) != 0))) {
-				*error = EXTCSS3_ERR_BYTES_CORRUPTION;
+	return i;
+}
 
-				return EXTCSS3_FAILURE;
-			}
+#if defined(EXTCSS3_HAVE_AVX2)
+__attribute__((target("avx2")))
+static size_t _extcss3_find_non_ascii_avx2(const char *str, size_t len)
+{
+	size_t i = 0;
+	unsigned int mask;
+
+	for (; (i + 32) <= len; i += 32) {
+		if ((mask = (unsigned int)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *)(str + i)))) != 0) {
+			return i + __builtin_ctz(mask);
+		}
+	}
+
+	return i + _extcss3_find_non_ascii(str + i, len - i);
+}
+#endif
+
+/**
+ * Get the length of the UTF-8 character at the start of the string, or 0 if its bytes are corrupt
+ */
+static inline size_t _extcss3_check_char_bytes(const unsigned char *str, size_t rest)
+{
+	size_t i, len = 0;
+
+	while ((len < 8) && ((str[0] << len) & 0x80)) {
+		len++;
+	}
+
+	// A continuation byte without a leading byte or a character beyond the end of the string
+	if ((len == 1) || (len == 8) || (len > rest)) {
+		return 0;
+	}
 
-			j++;
-			i--;
+	for (i = 1; i < len; i++) {
+		if ((str[i] & 0xC0) != 0x80) {
+			return 0;
 		}
+	}
 
-		if ((j == 1) || (j > intern->state.rest)) {
+	return len;
+}
+
+/**
+ * Check the validity of the bytes of all non-ASCII (UTF-8) characters of the string, "is_ascii" is set if there is none
+ */
+static inline bool _extcss3_check_bytes(const char *str, size_t len, bool *is_ascii, unsigned int *error)
+{
+	size_t i = 0, char_len;
+#if defined(EXTCSS3_HAVE_AVX2)
+	bool avx2 = extcss3_cpu_has_avx2();
+#endif
+
+	*is_ascii = true;
+
+	while (i < len) {
+#if defined(EXTCSS3_HAVE_AVX2)
+		if (avx2) {
+			i += _extcss3_find_non_ascii_avx2(str + i, len - i);
+		} else
+#endif
+		{
+			i += _extcss3_find_non_ascii(str + i, len - i);
+		}
+
+		if (i == len) {
+			break;
+		} else if ((char_len = _extcss3_check_char_bytes((const unsigned char *)str + i, len - i)) == 0) {
 			*error = EXTCSS3_ERR_BYTES_CORRUPTION;
 
 			return EXTCSS3_FAILURE;
 		}
+
+		*is_ascii = false;
+
+		i += char_len;
 	}
 
 	return EXTCSS3_SUCCESS;
 }
 
+/* ==================================================================================================== */
+
+/**
+ * Check the validity of the bytes of all non-ASCII (UTF-8) characters of the original string at once
+ */
+bool extcss3_check_bytes_corruption(extcss3_intern *intern, unsigned int *error)
+{
+	if ((intern == NULL) || (intern->orig.str == NULL)) {
+		*error = EXTCSS3_ERR_NULL_PTR;
+
+		return EXTCSS3_FAILURE;
+	}
+
+	return _extcss3_check_bytes(intern->orig.str, intern->orig.len, &intern->state.is_ascii, error);
+}
+
+/* ==================================================================================================== */
+
+/**
+ * Get the position of the first byte that needs the preprocessing ('\r', '\f' or '\0'), or "end" if there is none
+ */
+static inline const char *_extcss3_find_special(const char *str, const char *end)
+{
+#if defined(__SSE2__)
+	const __m128i cr = _mm_set1_epi8('\r'), ff = _mm_set1_epi8('\f'), nul = _mm_setzero_si128();
+	__m128i chunk;
+	int mask;
+
+	for (; (str + 16) <= end; str += 16) {
+		chunk = _mm_loadu_si128((const __m128i *)str);
+		mask = _mm_movemask_epi8(_mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, ff)),
+			_mm_cmpeq_epi8(chunk, nul)
+		));
+
+		if (mask != 0) {
+			return str + __builtin_ctz(mask);
+		}
+	}
+#endif
+
+	for (; str < end; str++) {
+		if ((*str == '\r') || (*str == '\f') || (*str == '\0')) {
+			break;
+		}
+	}
+
+	return str;
+}
+
+/**
+ * Write the normalized bytes of the string from "reader" to "end" to the "writer" pointer, returns the new writer
+ */
+static inline char *_extcss3_normalize(char *writer, const char *reader, const char *end)
+{
+	const char *next;
+
+	while (reader < end) {
+		if ((next = _extcss3_find_special(reader, end)) != reader) {
+			memcpy(writer, reader, next - reader);
+
+			writer += next - reader;
+			reader = next;
+		}
+
+		if (next == end) {
+			break;
+		} else if (*next == '\0') {
+			/* Add a U+FFFD REPLACEMENT CHARACTER (3 bytes) instead of the inside '\0' (1 byte) */
+			memcpy(writer, EXTCSS3_REPLACEMENT_CHR, EXTCSS3_REPLACEMENT_LEN);
+			writer += EXTCSS3_REPLACEMENT_LEN;
+			reader++;
+		} else {
+			/* Add '\n' (1 byte) instead of "\r\n" (2 bytes), '\r' or '\f' (1 byte) */
+			*writer++ = '\n';
+			reader += ((*next == '\r') && ((next + 1) < end) && (next[1] == '\n')) ? 2 : 1;
+		}
+	}
+
+	return writer;
+}
+
 /**
- * Copy a part of the input string to the intern CSS string and move the intern pointers to the new positions
+ * Get the number of bytes at the start of the chunk that can be preprocessed without the following chunk. The
+ * bytes of an incomplete character and a trailing '\r' (maybe the start of "\r\n") are held back.
  */
-static inline bool _extcss3_copy_and_move(extcss3_intern *intern, const char *src_str, size_t src_len, unsigned int processed)
+static inline size_t _extcss3_complete_len(const char *str, size_t len)
 {
-	memcpy(intern->state.writer, src_str, src_len);
+	size_t i = len, char_len = 0;
+
+	if ((len > 0) && (str[len - 1] == '\r')) {
+		return len - 1;
+	}
+
+	// Find the leading byte of the last character
+	while ((i > 0) && ((len - i) < (EXTCSS3_TAIL_SIZE - 2)) && (((unsigned char)str[i - 1] & 0xC0) == 0x80)) {
+		i--;
+	}
 
-	intern->state.rest -= processed;
+	if ((i == 0) || ((unsigned char)str[--i] < 0xC0)) {
+		return len;
+	}
 
-	intern->state.writer += src_len;
-	intern->state.cursor += processed;
+	while ((char_len < 8) && ((((unsigned char)str[i]) << char_len) & 0x80)) {
+		char_len++;
+	}
 
-	*intern->state.writer = '\0';
+	// Corrupt bytes are left to the check of the bytes
+	return ((char_len < 8) && (char_len > (len - i))) ? i : len;
+}
+
+/**
+ * Check and normalize the complete characters of a chunk, see extcss3_preprocess_chunk()
+ */
+static inline bool _extcss3_preprocess_run(extcss3_intern *intern, const char *str, size_t len, unsigned int *error)
+{
+	bool is_ascii;
+
+	if (EXTCSS3_SUCCESS != _extcss3_check_bytes(str, len, &is_ascii, error)) {
+		return EXTCSS3_FAILURE;
+	}
+
+	intern->state.writer = _extcss3_normalize(intern->state.writer, str, str + len);
 
 	return EXTCSS3_SUCCESS;
 }
 
 /**
  * Extended version of https://www.w3.org/TR/css-syntax-3/#input-preprocessing
+ *
+ * Normalizes the whole original string in one pass. The runs of ordinary bytes between the bytes to replace
+ * are copied at once. The result is placed behind the gap for the escapes, see extcss3_set_css_string(), and
+ * is followed by the zeroed padding of the copy-string.
  */
 bool extcss3_preprocess(extcss3_intern *intern, unsigned int *error)
 {
-	unsigned int len;
+	char *writer;
 
 	if ((intern == NULL) || (intern->state.cursor == NULL) || (intern->state.writer == NULL)) {
 		*error = EXTCSS3_ERR_NULL_PTR;
 
 		return EXTCSS3_FAILURE;
-	} else if ((intern->state.rest > 0) && (intern->state.rest <= intern->orig.len)) {
-		if (EXTCSS3_SUCCESS != _extcss3_check_bytes_corruption(intern, error)) {
-			return EXTCSS3_FAILURE;
-		}
-	} else if (intern->state.rest == 0) {
-		return EXTCSS3_SUCCESS;
 	}
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-	if (EXTCSS3_IS_NON_ASCII(*intern->state.cursor) && ((len = extcss3_char_len(*intern->state.cursor)) > 1)) {
-		/* Skip the following checks for the multibyte characters */
-		return _extcss3_copy_and_move(intern, intern->state.cursor, len, len);
-	} else if ((intern->state.rest > 0) && (*intern->state.cursor == '\0')) {
-		/* Add a U+FFFD REPLACEMENT CHARACTER (3 bytes) instead of the inside '\0' (1 byte) */
-		return _extcss3_copy_and_move(intern, EXTCSS3_REPLACEMENT_CHR, EXTCSS3_REPLACEMENT_LEN, 1);
-	} else if (*intern->state.cursor == '\r') { 
-		if (intern->state.cursor[1] == '\n') {
-			/* Add '\n' (1 byte) instead of "\r\n" (2 bytes) */
-			return _extcss3_copy_and_move(intern, "\n", 1, 2);
-		} else {
-			/* Add '\n' (1 byte) instead of '\r' (1 byte) */
-			return _extcss3_copy_and_move(intern, "\n", 1, 1);
+	if (intern->state.zero_copy) {
+		/* Nothing to replace, see extcss3_set_css_string() */
+		intern->state.writer = intern->state.cursor = intern->copy.str + intern->state.rest;
+		intern->state.rest = 0;
+
+		return EXTCSS3_SUCCESS;
+	}
+
+	writer = _extcss3_normalize(intern->state.cursor, intern->orig.str, intern->orig.str + intern->orig.len);
+
+	memset(writer, 0, (intern->copy.str + intern->copy.len + 1 + EXTCSS3_COPY_PADDING) - writer);
+
+	intern->state.rest = writer - intern->state.cursor;
+
+	// Without any room for the escapes, the normalized string is in place already
+	if (intern->state.cursor == intern->state.writer) {
+		intern->state.writer = intern->state.cursor = writer;
+		intern->state.rest = 0;
+	}
+
+	return EXTCSS3_SUCCESS;
+}
+
+/**
+ * Check and normalize the next chunk of the css string and append it to the bytes in front of the writer
+ *
+ * The bytes held back at the end of the previous chunk are completed first. The room for the normalized bytes
+ * has to be there already, see extcss3_push_css_chunk().
+ */
+bool extcss3_preprocess_chunk(extcss3_intern *intern, const char *str, size_t len, bool last, unsigned int *error)
+{
+	size_t i = 0, n;
+
+	if ((intern == NULL) || (intern->state.writer == NULL) || ((str == NULL) && (len > 0))) {
+		*error = EXTCSS3_ERR_NULL_PTR;
+
+		return EXTCSS3_FAILURE;
+	}
+
+	while ((intern->state.tail_len > 0) && ((i < len) || last)) {
+		if (i < len) {
+			intern->state.tail[intern->state.tail_len++] = str[i++];
+		}
+
+		n = (last && (i == len)) ? intern->state.tail_len : _extcss3_complete_len(intern->state.tail, intern->state.tail_len);
+
+		if (n > 0) {
+			if (EXTCSS3_SUCCESS != _extcss3_preprocess_run(intern, intern->state.tail, n, error)) {
+				return EXTCSS3_FAILURE;
+			}
+
+			memmove(intern->state.tail, intern->state.tail + n, intern->state.tail_len - n);
+			intern->state.tail_len -= n;
 		}
-	} else if (*intern->state.cursor == '\f') {
-		/* Add '\n' (1 byte) instead of '\f' (1 byte) */
-		return _extcss3_copy_and_move(intern, "\n", 1, 1);
-	} else {
-		return _extcss3_copy_and_move(intern, intern->state.cursor, 1, 1);
+	}
+
+	if (i < len) {
+		n = last ? (len - i) : _extcss3_complete_len(str + i, len - i);
+
+		if (EXTCSS3_SUCCESS != _extcss3_preprocess_run(intern, str + i, n, error)) {
+			return EXTCSS3_FAILURE;
+		}
+
+		memcpy(intern->state.tail, str + i + n, len - i - n);
+		intern->state.tail_len = len - i - n;
+	}
+
+	return EXTCSS3_SUCCESS;
+}
+
+/**
+ * Move the next run of up to EXTCSS3_PREPROCESS_RUN normalized bytes in front of the writer
+ */
+void extcss3_preprocess_move(extcss3_intern *intern)
+{
+	size_t len = (intern->state.rest < EXTCSS3_PREPROCESS_RUN) ? intern->state.rest : EXTCSS3_PREPROCESS_RUN;
+
+	memmove(intern->state.writer, intern->state.cursor, len);
+
+	intern->state.rest -= len;
+
+	intern->state.writer += len;
+	intern->state.cursor += len;
+
+	// The gap becomes a part of the padding
+	if (intern->state.rest == 0) {
+		memset(intern->state.writer, 0, intern->state.cursor - intern->state.writer);
+	}
+}
+
+/**
+ * Replace the "len" bytes at "pos" by the "str_len" bytes of "str", only the bytes in front of the writer are moved
+ */
+void extcss3_preprocess_replace(extcss3_intern *intern, char *pos, size_t len, const char *str, size_t str_len)
+{
+	char *writer = intern->state.writer;
+
+	memmove(pos + str_len, pos + len, writer - (pos + len));
+	memcpy(pos, str, str_len);
+
+	intern->state.writer += str_len;
+	intern->state.writer -= len;
+
+	if (intern->state.writer == intern->state.cursor) {
+		// The growth of the escapes has closed the gap, see extcss3_set_css_string()
+		intern->state.writer += intern->state.rest;
+		intern->state.cursor += intern->state.rest;
+		intern->state.rest = 0;
+	} else if (intern->state.writer < writer) {
+		memset(intern->state.writer, 0, writer - intern->state.writer);
 	}
 }
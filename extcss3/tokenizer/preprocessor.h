@@ -5,6 +5,18 @@
 
 /* ==================================================================================================== */
 
+/* Number of normalized bytes that are moved in front of the writer at once, see extcss3_preprocess_move() */
+#define EXTCSS3_PREPROCESS_RUN		((size_t)1024)
+
+/* Minimum number of preprocessed bytes ahead of the reader of the tokenizer (the lookahead of 5 characters) */
+#define EXTCSS3_PREPROCESS_AHEAD	((size_t)64)
+
+/* ==================================================================================================== */
+
+bool extcss3_check_bytes_corruption(extcss3_intern *intern, unsigned int *error);
 bool extcss3_preprocess(extcss3_intern *intern, unsigned int *error);
+bool extcss3_preprocess_chunk(extcss3_intern *intern, const char *str, size_t len, bool last, unsigned int *error);
+void extcss3_preprocess_move(extcss3_intern *intern);
+void extcss3_preprocess_replace(extcss3_intern *intern, char *pos, size_t len, const char *str, size_t str_len);
 
 #endif /* EXTCSS3_TOKENIZER_PREPROCESSOR_H */
@@ -0,0 +1,409 @@
+#include "../utils.h"
+#include "scanner.h"
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+#if defined(EXTCSS3_HAVE_AVX2)
+# include <immintrin.h>
+#endif
+
+/* ==================================================================================================== */
+
+/**
+ * Whether the byte may end an unquoted url or needs a closer look: '"', '\'', '(', ')', '\\', whitespace and
+ * non-printables. All control bytes are included, '\f' and '\r' are gone after the preprocessing anyway.
+ */
+#define _EXTCSS3_URL_STOP(c) (							\
+	((unsigned char)(c) <= 0x20) || ((c) == 0x7F)	||	\
+	((c) == '"') || ((c) == '\'') || ((c) == '(')	||	\
+	((c) == ')') || ((c) == '\\')						\
+)
+
+/* ==================================================================================================== */
+
+/**
+ * Get the number of leading whitespace bytes of the string
+ */
+static inline size_t _extcss3_scan_ws(const char *str, size_t len)
+{
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	const __m128i sp = _mm_set1_epi8(' '), nl = _mm_set1_epi8('\n'), tab = _mm_set1_epi8('\t');
+	__m128i chunk;
+	int mask;
+
+	for (; (i + 16) <= len; i += 16) {
+		chunk = _mm_loadu_si128((const __m128i *)(str + i));
+		mask = _mm_movemask_epi8(_mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, sp), _mm_cmpeq_epi8(chunk, nl)),
+			_mm_cmpeq_epi8(chunk, tab)
+		));
+
+		if (mask != 0xFFFF) {
+			return i + __builtin_ctz(~mask);
+		}
+	}
+#endif
+
+	for (; i < len; i++) {
+		if (!EXTCSS3_IS_WS(str[i])) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+#if defined(EXTCSS3_HAVE_AVX2)
+__attribute__((target("avx2")))
+static size_t _extcss3_scan_ws_avx2(const char *str, size_t len)
+{
+	const __m256i sp = _mm256_set1_epi8(' '), nl = _mm256_set1_epi8('\n'), tab = _mm256_set1_epi8('\t');
+	__m256i chunk;
+	unsigned int mask;
+	size_t i = 0;
+
+	for (; (i + 32) <= len; i += 32) {
+		chunk = _mm256_loadu_si256((const __m256i *)(str + i));
+		mask = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(chunk, sp), _mm256_cmpeq_epi8(chunk, nl)),
+			_mm256_cmpeq_epi8(chunk, tab)
+		));
+
+		if (mask != 0xFFFFFFFF) {
+			return i + __builtin_ctz(~mask);
+		}
+	}
+
+	return i + _extcss3_scan_ws(str + i, len - i);
+}
+#endif
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/**
+ * Get the position of the first "*\/" of the string, a trailing '*' counts as the possible start of one
+ */
+static inline size_t _extcss3_scan_comment(const char *str, size_t len)
+{
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	const __m128i star = _mm_set1_epi8('*'), slash = _mm_set1_epi8('/');
+	int mask;
+
+	for (; (i + 17) <= len; i += 16) {
+		mask = _mm_movemask_epi8(_mm_and_si128(
+			_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(str + i)), star),
+			_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(str + i + 1)), slash)
+		));
+
+		if (mask != 0) {
+			return i + __builtin_ctz(mask);
+		}
+	}
+#endif
+
+	for (; i < len; i++) {
+		if ((str[i] == '*') && (((i + 1) == len) || (str[i + 1] == '/'))) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+#if defined(EXTCSS3_HAVE_AVX2)
+__attribute__((target("avx2")))
+static size_t _extcss3_scan_comment_avx2(const char *str, size_t len)
+{
+	const __m256i star = _mm256_set1_epi8('*'), slash = _mm256_set1_epi8('/');
+	unsigned int mask;
+	size_t i = 0;
+
+	for (; (i + 33) <= len; i += 32) {
+		mask = (unsigned int)_mm256_movemask_epi8(_mm256_and_si256(
+			_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(str + i)), star),
+			_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(str + i + 1)), slash)
+		));
+
+		if (mask != 0) {
+			return i + __builtin_ctz(mask);
+		}
+	}
+
+	return i + _extcss3_scan_comment(str + i, len - i);
+}
+#endif
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/**
+ * Get the position of the first quote, '\\' or '\n' of the string
+ */
+static inline size_t _extcss3_scan_string(const char *str, size_t len, char quote)
+{
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	const __m128i q = _mm_set1_epi8(quote), bs = _mm_set1_epi8('\\'), nl = _mm_set1_epi8('\n');
+	__m128i chunk;
+	int mask;
+
+	for (; (i + 16) <= len; i += 16) {
+		chunk = _mm_loadu_si128((const __m128i *)(str + i));
+		mask = _mm_movemask_epi8(_mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, q), _mm_cmpeq_epi8(chunk, bs)),
+			_mm_cmpeq_epi8(chunk, nl)
+		));
+
+		if (mask != 0) {
+			return i + __builtin_ctz(mask);
+		}
+	}
+#endif
+
+	for (; i < len; i++) {
+		if ((str[i] == quote) || (str[i] == '\\') || (str[i] == '\n')) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+#if defined(EXTCSS3_HAVE_AVX2)
+__attribute__((target("avx2")))
+static size_t _extcss3_scan_string_avx2(const char *str, size_t len, char quote)
+{
+	const __m256i q = _mm256_set1_epi8(quote), bs = _mm256_set1_epi8('\\'), nl = _mm256_set1_epi8('\n');
+	__m256i chunk;
+	unsigned int mask;
+	size_t i = 0;
+
+	for (; (i + 32) <= len; i += 32) {
+		chunk = _mm256_loadu_si256((const __m256i *)(str + i));
+		mask = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(chunk, q), _mm256_cmpeq_epi8(chunk, bs)),
+			_mm256_cmpeq_epi8(chunk, nl)
+		));
+
+		if (mask != 0) {
+			return i + __builtin_ctz(mask);
+		}
+	}
+
+	return i + _extcss3_scan_string(str + i, len - i, quote);
+}
+#endif
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/**
+ * Get the position of the first byte of the string that may end an unquoted url
+ */
+static inline size_t _extcss3_scan_url(const char *str, size_t len)
+{
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	const __m128i sp = _mm_set1_epi8(' '), del = _mm_set1_epi8(0x7F), dq = _mm_set1_epi8('"'),
+		sq = _mm_set1_epi8('\''), lp = _mm_set1_epi8('('), rp = _mm_set1_epi8(')'), bs = _mm_set1_epi8('\\');
+	__m128i chunk, stop;
+	int mask;
+
+	for (; (i + 16) <= len; i += 16) {
+		chunk = _mm_loadu_si128((const __m128i *)(str + i));
+
+		// The unsigned "chunk <= ' '" is "min(chunk, ' ') == chunk"
+		stop = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(chunk, sp), chunk), _mm_cmpeq_epi8(chunk, del));
+		stop = _mm_or_si128(stop, _mm_or_si128(_mm_cmpeq_epi8(chunk, dq), _mm_cmpeq_epi8(chunk, sq)));
+		stop = _mm_or_si128(stop, _mm_or_si128(_mm_cmpeq_epi8(chunk, lp), _mm_cmpeq_epi8(chunk, rp)));
+		stop = _mm_or_si128(stop, _mm_cmpeq_epi8(chunk, bs));
+
+		if ((mask = _mm_movemask_epi8(stop)) != 0) {
+			return i + __builtin_ctz(mask);
+		}
+	}
+#endif
+
+	for (; i < len; i++) {
+		if (_EXTCSS3_URL_STOP(str[i])) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+#if defined(EXTCSS3_HAVE_AVX2)
+__attribute__((target("avx2")))
+static size_t _extcss3_scan_url_avx2(const char *str, size_t len)
+{
+	const __m256i sp = _mm256_set1_epi8(' '), del = _mm256_set1_epi8(0x7F), dq = _mm256_set1_epi8('"'),
+		sq = _mm256_set1_epi8('\''), lp = _mm256_set1_epi8('('), rp = _mm256_set1_epi8(')'), bs = _mm256_set1_epi8('\\');
+	__m256i chunk, stop;
+	unsigned int mask;
+	size_t i = 0;
+
+	for (; (i + 32) <= len; i += 32) {
+		chunk = _mm256_loadu_si256((const __m256i *)(str + i));
+
+		stop = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(chunk, sp), chunk), _mm256_cmpeq_epi8(chunk, del));
+		stop = _mm256_or_si256(stop, _mm256_or_si256(_mm256_cmpeq_epi8(chunk, dq), _mm256_cmpeq_epi8(chunk, sq)));
+		stop = _mm256_or_si256(stop, _mm256_or_si256(_mm256_cmpeq_epi8(chunk, lp), _mm256_cmpeq_epi8(chunk, rp)));
+		stop = _mm256_or_si256(stop, _mm256_cmpeq_epi8(chunk, bs));
+
+		if ((mask = (unsigned int)_mm256_movemask_epi8(stop)) != 0) {
+			return i + __builtin_ctz(mask);
+		}
+	}
+
+	return i + _extcss3_scan_url(str + i, len - i);
+}
+#endif
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/**
+ * Get the number of leading name code point bytes of the string, all bytes of non-ASCII characters included
+ */
+static inline size_t _extcss3_scan_name(const char *str, size_t len)
+{
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	const __m128i lower = _mm_set1_epi8(0x20), a = _mm_set1_epi8('a'), zero = _mm_set1_epi8('0'),
+		letters = _mm_set1_epi8(25), digits = _mm_set1_epi8(9), us = _mm_set1_epi8('_'), hy = _mm_set1_epi8('-');
+	__m128i chunk, tmp, name;
+	int mask;
+
+	for (; (i + 16) <= len; i += 16) {
+		chunk = _mm_loadu_si128((const __m128i *)(str + i));
+
+		// The unsigned "x <= n" is "min(x, n) == x", bytes with the high bit set are non-ASCII
+		tmp = _mm_sub_epi8(_mm_or_si128(chunk, lower), a);
+		name = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(tmp, letters), tmp), _mm_cmplt_epi8(chunk, _mm_setzero_si128()));
+		tmp = _mm_sub_epi8(chunk, zero);
+		name = _mm_or_si128(name, _mm_cmpeq_epi8(_mm_min_epu8(tmp, digits), tmp));
+		name = _mm_or_si128(name, _mm_or_si128(_mm_cmpeq_epi8(chunk, us), _mm_cmpeq_epi8(chunk, hy)));
+
+		if ((mask = _mm_movemask_epi8(name)) != 0xFFFF) {
+			return i + __builtin_ctz(~mask);
+		}
+	}
+#endif
+
+	for (; i < len; i++) {
+		if (!EXTCSS3_IS_NAME(str[i])) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+#if defined(EXTCSS3_HAVE_AVX2)
+__attribute__((target("avx2")))
+static size_t _extcss3_scan_name_avx2(const char *str, size_t len)
+{
+	const __m256i lower = _mm256_set1_epi8(0x20), a = _mm256_set1_epi8('a'), zero = _mm256_set1_epi8('0'),
+		letters = _mm256_set1_epi8(25), digits = _mm256_set1_epi8(9), us = _mm256_set1_epi8('_'), hy = _mm256_set1_epi8('-');
+	__m256i chunk, tmp, name;
+	unsigned int mask;
+	size_t i = 0;
+
+	for (; (i + 32) <= len; i += 32) {
+		chunk = _mm256_loadu_si256((const __m256i *)(str + i));
+
+		tmp = _mm256_sub_epi8(_mm256_or_si256(chunk, lower), a);
+		name = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(tmp, letters), tmp), _mm256_cmpgt_epi8(_mm256_setzero_si256(), chunk));
+		tmp = _mm256_sub_epi8(chunk, zero);
+		name = _mm256_or_si256(name, _mm256_cmpeq_epi8(_mm256_min_epu8(tmp, digits), tmp));
+		name = _mm256_or_si256(name, _mm256_or_si256(_mm256_cmpeq_epi8(chunk, us), _mm256_cmpeq_epi8(chunk, hy)));
+
+		if ((mask = (unsigned int)_mm256_movemask_epi8(name)) != 0xFFFFFFFF) {
+			return i + __builtin_ctz(~mask);
+		}
+	}
+
+	return i + _extcss3_scan_name(str + i, len - i);
+}
+#endif
+
+/* ==================================================================================================== */
+
+/**
+ * Get the number of leading whitespace bytes of the "len" bytes of the string
+ */
+size_t extcss3_scan_ws(const char *str, size_t len)
+{
+#if defined(EXTCSS3_HAVE_AVX2)
+	if (extcss3_cpu_has_avx2()) {
+		return _extcss3_scan_ws_avx2(str, len);
+	}
+#endif
+
+	return _extcss3_scan_ws(str, len);
+}
+
+/**
+ * Get the number of bytes in front of the first "*\/" of the "len" bytes of the string
+ *
+ * A '*' as the last of the bytes stops the scan as well, since the following byte is unknown to the scanner.
+ */
+size_t extcss3_scan_comment(const char *str, size_t len)
+{
+#if defined(EXTCSS3_HAVE_AVX2)
+	if (extcss3_cpu_has_avx2()) {
+		return _extcss3_scan_comment_avx2(str, len);
+	}
+#endif
+
+	return _extcss3_scan_comment(str, len);
+}
+
+/**
+ * Get the number of bytes in front of the first quote, '\\' or '\n' of the "len" bytes of the string
+ */
+size_t extcss3_scan_string(const char *str, size_t len, char quote)
+{
+#if defined(EXTCSS3_HAVE_AVX2)
+	if (extcss3_cpu_has_avx2()) {
+		return _extcss3_scan_string_avx2(str, len, quote);
+	}
+#endif
+
+	return _extcss3_scan_string(str, len, quote);
+}
+
+/**
+ * Get the number of ordinary bytes at the start of the "len" bytes of the body of an unquoted url
+ */
+size_t extcss3_scan_url(const char *str, size_t len)
+{
+#if defined(EXTCSS3_HAVE_AVX2)
+	if (extcss3_cpu_has_avx2()) {
+		return _extcss3_scan_url_avx2(str, len);
+	}
+#endif
+
+	return _extcss3_scan_url(str, len);
+}
+
+/**
+ * Get the number of leading name code point bytes of the "len" bytes of the string
+ */
+size_t extcss3_scan_name(const char *str, size_t len)
+{
+#if defined(EXTCSS3_HAVE_AVX2)
+	if (extcss3_cpu_has_avx2()) {
+		return _extcss3_scan_name_avx2(str, len);
+	}
+#endif
+
+	return _extcss3_scan_name(str, len);
+}
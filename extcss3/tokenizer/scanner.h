@@ -0,0 +1,14 @@
+#ifndef EXTCSS3_TOKENIZER_SCANNER_H
+#define EXTCSS3_TOKENIZER_SCANNER_H
+
+#include "../types.h"
+
+/* ==================================================================================================== */
+
+size_t extcss3_scan_ws(const char *str, size_t len);
+size_t extcss3_scan_comment(const char *str, size_t len);
+size_t extcss3_scan_string(const char *str, size_t len, char quote);
+size_t extcss3_scan_url(const char *str, size_t len);
+size_t extcss3_scan_name(const char *str, size_t len);
+
+#endif /* EXTCSS3_TOKENIZER_SCANNER_H */
@@ -1,6 +1,10 @@
+#include "../allocator.h"
 #include "../intern.h"
+#include "../keywords.h"
+#include "../number.h"
 #include "../utils.h"
 #include "preprocessor.h"
+#include "scanner.h"
 #include "context.h"
 #include "tokenizer.h"
 
@@ -9,34 +13,29 @@
 
 /* ==================================================================================================== */
 
-#define _EXTCSS3_NEXT(intern, error) do {				\
-	bool result = _extcss3_next_char(intern, error);	\
-	if (EXTCSS3_SUCCESS != result) {					\
-		return EXTCSS3_FAILURE;							\
-	}													\
-} while (0)
-
-#define _EXTCSS3_FILL_FIXED_TOKEN(intern, token, type, chars, error) do {		\
-	bool result = _extcss3_fill_fixed_token(intern, token, type, chars, error);	\
-	if (EXTCSS3_SUCCESS != result) {											\
-		return _extcss3_cleanup_tokenizer(*error, intern, true, true);			\
-	}																			\
-} while (0)
+#define _EXTCSS3_OFFSET(intern, ptr)	((uint32_t)((ptr) - (intern)->copy.str))
 
 /* ==================================================================================================== */
 
 /* HELPER */
 static bool _extcss3_cleanup_tokenizer(unsigned int error, extcss3_intern *intern, bool token, bool ctxt);
-static bool _extcss3_next_char(extcss3_intern *intern, unsigned int *error);
+static void _extcss3_next_char(extcss3_intern *intern);
+static void _extcss3_skip_bytes(extcss3_intern *intern, size_t len);
+static void _extcss3_skip_ws(extcss3_intern *intern);
+static extcss3_token *_extcss3_reuse_token(extcss3_intern *intern, extcss3_token *token);
+static void _extcss3_compact_numbers(extcss3_intern *intern);
+static bool _extcss3_save_patch(extcss3_intern *intern, const char *pos, size_t len, unsigned int *error);
+static void _extcss3_restore_patches(extcss3_intern *intern);
 static bool _extcss3_token_add(extcss3_intern *intern, extcss3_token *token, unsigned int *error);
 
 /* TOKEN FILLER */
-static bool _extcss3_fill_fixed_token(extcss3_intern *intern, extcss3_token *token, unsigned int type, unsigned int chars, unsigned int *error);
-static bool _extcss3_fill_ws_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error);
+static bool _extcss3_fill_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error);
+static void _extcss3_fill_fixed_token(extcss3_intern *intern, extcss3_token *token, unsigned int type, unsigned int chars);
+static void _extcss3_fill_ws_token(extcss3_intern *intern, extcss3_token *token);
 static bool _extcss3_fill_hash_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error);
 static bool _extcss3_fill_at_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error);
-static bool _extcss3_fill_comment_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error);
-static bool _extcss3_fill_unicode_range_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error);
+static void _extcss3_fill_comment_token(extcss3_intern *intern, extcss3_token *token);
+static void _extcss3_fill_unicode_range_token(extcss3_intern *intern, extcss3_token *token);
 static bool _extcss3_fill_ident_like_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error);
 static bool _extcss3_fill_url_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error);
 static bool _extcss3_fill_string_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error);
@@ -56,310 +55,162 @@ static bool _extcss3_check_is_name(const char *str);
 
 /* ==================================================================================================== */
 
-bool extcss3_tokenize(extcss3_intern *intern, unsigned int *error)
+/**
+ * Prepare the tokenizing of the css string, the tokens are taken by extcss3_next_token() afterwards
+ *
+ * In the "stream" mode at most two tokens are kept: the last one and the last one that is no whitespace or
+ * comment (as its "prev" token). The slots of all other tokens are reused, so the memory of the tokens stays
+ * constant for any length of the string. The modifiers need all tokens and are not supported in this mode.
+ */
+bool extcss3_tokenizer_start(extcss3_intern *intern, bool stream, unsigned int *error)
 {
-	extcss3_token *token;
-	unsigned int i;
-	char *reader;
-
-	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
 	if ((intern == NULL) || (intern->copy.str == NULL)) {
 		return _extcss3_cleanup_tokenizer(*error = EXTCSS3_ERR_NULL_PTR, NULL, false, false);
-	} else if ((intern->base_token = token = extcss3_create_token()) == NULL) {
-		return _extcss3_cleanup_tokenizer(*error = EXTCSS3_ERR_MEMORY, NULL, false, false);
+	} else if (stream && EXTCSS3_HAS_MODIFIER(intern)) {
+		return _extcss3_cleanup_tokenizer(*error = EXTCSS3_ERR_INV_PARAM, NULL, false, false);
+	} else if (!intern->state.chunked && (EXTCSS3_SUCCESS != extcss3_check_bytes_corruption(intern, error))) {
+		return _extcss3_cleanup_tokenizer(*error, NULL, false, false);
 	} else if (
 		EXTCSS3_HAS_MODIFIER(intern) &&
-		((intern->base_ctxt = intern->last_ctxt = extcss3_create_ctxt()) == NULL)
+		(EXTCSS3_SUCCESS != extcss3_ctxt_reset(intern, error))
 	) {
-		return _extcss3_cleanup_tokenizer(*error = EXTCSS3_ERR_MEMORY, intern, true, false);
+		return _extcss3_cleanup_tokenizer(*error, intern, false, false);
 	}
 
+	intern->state.stream = stream;
+	intern->state.at_import = false;
+
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 	/**
-	 * To be able to identify some token types, we must be able to
-	 * look forward in the "prepared" string. Therefore we "preload"
-	 * "i" characters. The "reader" and "writer" pointers of the
-	 * state machine run in parallel but offset by "i" characters.
+	 * The whole string is preprocessed before the tokenizing. To be
+	 * able to identify some token types, we must be able to look
+	 * forward in the "prepared" string. If the escapes may move the
+	 * bytes, only the bytes in front of the "writer" pointer are in
+	 * place, it is kept at least EXTCSS3_PREPROCESS_AHEAD bytes ahead
+	 * of the "reader" pointer by _extcss3_next_char(). The chunks
+	 * of a chunked string are preprocessed as they are pushed.
 	 */
-	for (i = 5; i--; ) {
-		if (EXTCSS3_SUCCESS != extcss3_preprocess(intern, error)) {
-			return _extcss3_cleanup_tokenizer(*error, intern, true, true);
-		}
+	if (!intern->state.chunked && (EXTCSS3_SUCCESS != extcss3_preprocess(intern, error))) {
+		return _extcss3_cleanup_tokenizer(*error, intern, false, true);
 	}
 
-	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+	while ((intern->state.rest > 0) && ((size_t)(intern->state.writer - intern->state.reader) < EXTCSS3_PREPROCESS_AHEAD)) {
+		extcss3_preprocess_move(intern);
+	}
 
-	/* https://www.w3.org/TR/css-syntax-3/#consume-a-token */
-	while ((intern->last_token == NULL) || (intern->last_token->type != EXTCSS3_TYPE_EOF)) {
-		reader = intern->state.reader;
-
-		switch (*reader) {
-			case ' ':
-			case '\n':
-			case '\t':
-			{
-				if (EXTCSS3_SUCCESS != _extcss3_fill_ws_token(intern, token, error)) {
-					return _extcss3_cleanup_tokenizer(*error, intern, true, true);
-				}
+	return EXTCSS3_SUCCESS;
+}
 
-				break;
-			}
-			case '"':
-			case '\'':
-			{
-				if (EXTCSS3_SUCCESS != _extcss3_fill_string_token(intern, token, error)) {
-					return _extcss3_cleanup_tokenizer(*error, intern, true, true);
-				}
+/**
+ * Consume the next token and append it to the token list. After the EOF token, the EOF token is returned again.
+ *
+ * Returns NULL on failure, all tokens are released then. Returns NULL with "error" 0 if a chunked string needs
+ * the next chunk: a token is only taken if EXTCSS3_PREPROCESS_AHEAD bytes follow it, otherwise it is dropped
+ * (its escapes are restored) and consumed again after the next extcss3_push_css_chunk(). To keep long tokens
+ * from being consumed again for every small chunk, the bytes in front of the reader have to double first.
+ */
+extcss3_token *extcss3_next_token(extcss3_intern *intern, unsigned int *error)
+{
+	extcss3_token *token;
+	size_t numbers_len;
+	char *reader;
 
-				break;
-			}
-			case '#':
-			{
-				if (
-					(EXTCSS3_SUCCESS == _extcss3_check_is_name(reader + 1)) ||
-					(EXTCSS3_SUCCESS == _extcss3_check_start_valid_escape(reader + 1))
-				) {
-					if (EXTCSS3_SUCCESS != _extcss3_fill_hash_token(intern, token, error)) {
-						return _extcss3_cleanup_tokenizer(*error, intern, true, true);
-					}
-				} else {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_DELIM, 1, error);
-				}
+	if ((intern == NULL) || (intern->state.reader == NULL)) {
+		_extcss3_cleanup_tokenizer(*error = EXTCSS3_ERR_NULL_PTR, NULL, false, false);
 
-				break;
-			}
-			case '$':
-			{
-				if (reader[1] == '=') {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_SUFFIX_MATCH, 2, error);
-				} else {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_DELIM, 1, error);
-				}
+		return NULL;
+	} else if ((intern->last_token != NULL) && (EXTCSS3_TOKEN_TYPE(intern, intern->last_token) == EXTCSS3_TYPE_EOF)) {
+		return intern->last_token;
+	} else if (
+		intern->state.chunked && !intern->state.finished &&
+		((size_t)(intern->state.writer - intern->state.reader) < intern->state.ahead)
+	) {
+		*error = 0;
 
-				break;
-			}
-			case '(':
-			{
-				_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_BR_RO, 1, error);
-				break;
-			}
-			case ')':
-			{
-				_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_BR_RC, 1, error);
-				break;
-			}
-			case '[':
-			{
-				_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_BR_SO, 1, error);
-				break;
-			}
-			case ']':
-			{
-				_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_BR_SC, 1, error);
-				break;
-			}
-			case '{':
-			{
-				_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_BR_CO, 1, error);
-				break;
-			}
-			case '}':
-			{
-				_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_BR_CC, 1, error);
-				break;
-			}
-			case ',':
-			{
-				_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_COMMA, 1, error);
-				break;
-			}
-			case ':':
-			{
-				_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_COLON, 1, error);
-				break;
-			}
-			case ';':
-			{
-				_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_SEMICOLON, 1, error);
-				break;
-			}
-			case '*':
-			{
-				if (reader[1] == '=') {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_SUBSTR_MATCH, 2, error);
-				} else {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_DELIM, 1, error);
-				}
+		return NULL;
+	} else if ((token = extcss3_create_token(intern)) == NULL) {
+		_extcss3_cleanup_tokenizer(*error = EXTCSS3_ERR_MEMORY, intern, true, true);
 
-				break;
-			}
-			case '+':
-			case '.':
-			{
-				if (EXTCSS3_SUCCESS == _extcss3_check_start_number(reader)) {
-					if (EXTCSS3_SUCCESS != _extcss3_fill_number_token(intern, token, error)) {
-						return _extcss3_cleanup_tokenizer(*error, intern, true, true);
-					}
-				} else {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_DELIM, 1, error);
-				}
+		return NULL;
+	}
 
-				break;
-			}
-			case '-':
-			{
-				if (EXTCSS3_SUCCESS == _extcss3_check_start_number(reader)) {
-					if (EXTCSS3_SUCCESS != _extcss3_fill_number_token(intern, token, error)) {
-						return _extcss3_cleanup_tokenizer(*error, intern, true, true);
-					}
-				} else if (EXTCSS3_SUCCESS == _extcss3_check_start_ident(reader)) {
-					if (EXTCSS3_SUCCESS != _extcss3_fill_ident_like_token(intern, token, error)) {
-						return _extcss3_cleanup_tokenizer(*error, intern, true, true);
-					}
-				} else if ((reader[1] == '-') && (reader[2] == '>')) {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_CDC, 3, error);
-				} else {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_DELIM, 1, error);
-				}
+	reader = intern->state.reader;
+	numbers_len = intern->numbers_len;
+	intern->patches_len = 0;
 
-				break;
-			}
-			case '/':
-			{
-				if (reader[1] == '*') {
-					if (EXTCSS3_SUCCESS != _extcss3_fill_comment_token(intern, token, error)) {
-						return _extcss3_cleanup_tokenizer(*error, intern, true, true);
-					}
-				} else {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_DELIM, 1, error);
-				}
+	if (EXTCSS3_SUCCESS != _extcss3_fill_token(intern, token, error)) {
+		_extcss3_cleanup_tokenizer(*error, intern, true, true);
 
-				break;
-			}
-			case '<':
-			{
-				if (reader[1] == '!' && reader[2] == '-' && reader[3] == '-') {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_CDO, 4, error);
-				} else {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_DELIM, 1, error);
-				}
+		return NULL;
+	}
 
-				break;
-			}
-			case '@':
-			{
-				if (EXTCSS3_SUCCESS == _extcss3_check_start_ident(reader + 1)) {
-					if (EXTCSS3_SUCCESS != _extcss3_fill_at_token(intern, token, error)) {
-						return _extcss3_cleanup_tokenizer(*error, intern, true, true);
-					}
-				} else {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_DELIM, 1, error);
-				}
+	if (
+		intern->state.chunked && !intern->state.finished &&
+		((size_t)(intern->state.writer - intern->state.reader) < EXTCSS3_PREPROCESS_AHEAD)
+	) {
+		_extcss3_restore_patches(intern);
 
-				break;
-			}
-			case '\\':
-			{
-				if (EXTCSS3_SUCCESS == _extcss3_check_start_valid_escape(reader + 1)) {
-					if (EXTCSS3_SUCCESS != _extcss3_fill_ident_like_token(intern, token, error)) {
-						return _extcss3_cleanup_tokenizer(*error, intern, true, true);
-					}
-				} else {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_DELIM, 1, error);
-				}
+		intern->state.reader = reader;
+		intern->state.ahead = ((intern->state.writer - reader) * 2) + EXTCSS3_PREPROCESS_AHEAD;
+		intern->tokens_len--;
+		intern->numbers_len = numbers_len;
+		*error = 0;
 
-				break;
-			}
-			case '^':
-			{
-				if (reader[1] == '=') {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_PREFIX_MATCH, 2, error);
-				} else {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_DELIM, 1, error);
-				}
+		return NULL;
+	}
 
-				break;
-			}
-			case '|':
-			{
-				if (reader[1] == '=') {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_DASH_MATCH, 2, error);
-				} else if (reader[1] == '|') {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_COLUMN, 2, error);
-				} else {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_DELIM, 1, error);
-				}
+	intern->state.ahead = 0;
 
-				break;
-			}
-			case '~':
-			{
-				if (reader[1] == '=') {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_INCLUDE_MATCH, 2, error);
-				} else {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_DELIM, 1, error);
-				}
+	if (intern->state.stream) {
+		token = _extcss3_reuse_token(intern, token);
+	}
 
-				break;
-			}
-			case 'u':
-			case 'U':
-			{
-				if ((reader[1] == '+') && ((reader[2] == '?') || EXTCSS3_IS_HEX(reader[2]))) {
-					if (EXTCSS3_SUCCESS != _extcss3_fill_unicode_range_token(intern, token, error)) {
-						return _extcss3_cleanup_tokenizer(*error, intern, true, true);
-					}
-				} else {
-					if (EXTCSS3_SUCCESS != _extcss3_fill_ident_like_token(intern, token, error)) {
-						return _extcss3_cleanup_tokenizer(*error, intern, true, true);
-					}
-				}
+	if (EXTCSS3_SUCCESS != _extcss3_token_add(intern, token, error)) {
+		_extcss3_cleanup_tokenizer(*error, intern, true, true);
 
-				break;
-			}
-			case '\0':
-			{
-				_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_EOF, 1, error);
-				break;
-			}
-			default:
-			{
-				if (EXTCSS3_IS_DIGIT(*reader)) {
-					if (EXTCSS3_SUCCESS != _extcss3_fill_number_token(intern, token, error)) {
-						return _extcss3_cleanup_tokenizer(*error, intern, true, true);
-					}
-				} else if (EXTCSS3_SUCCESS == _extcss3_check_start_name(reader)) {
-					if (EXTCSS3_SUCCESS != _extcss3_fill_ident_like_token(intern, token, error)) {
-						return _extcss3_cleanup_tokenizer(*error, intern, true, true);
-					}
-				} else {
-					_EXTCSS3_FILL_FIXED_TOKEN(intern, token, EXTCSS3_TYPE_DELIM, 1, error);
-				}
+		return NULL;
+	}
 
-				break;
-			}
-		}
+	if (intern->base_token == NULL) {
+		intern->base_token = token;
+	} else if (intern->state.stream) {
+		intern->base_token = (token->prev != 0) ? EXTCSS3_TOKEN_PREV(intern, token) : token;
 
-		/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+		_extcss3_compact_numbers(intern);
+	}
 
-		if (EXTCSS3_SUCCESS != _extcss3_token_add(intern, token, error)) {
-			return _extcss3_cleanup_tokenizer(*error, intern, true, true);
-		}
+	// The context stack is kept allocated for the next run
+	if (EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_EOF) {
+		_extcss3_cleanup_tokenizer(0, intern, false, true);
+	}
 
-		/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+	return token;
+}
 
-		if (token->type == EXTCSS3_TYPE_EOF) {
-			break;
-		} else if ((token = extcss3_create_token()) == NULL) {
-			return _extcss3_cleanup_tokenizer(*error = EXTCSS3_ERR_MEMORY, intern, true, true);
-		}
+/**
+ * Consume all tokens of the css string into the token list
+ */
+bool extcss3_tokenize(extcss3_intern *intern, unsigned int *error)
+{
+	extcss3_token *token;
+
+	if (EXTCSS3_SUCCESS != extcss3_tokenizer_start(intern, false, error)) {
+		return EXTCSS3_FAILURE;
 	}
 
-	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+	do {
+		if ((token = extcss3_next_token(intern, error)) == NULL) {
+			// All chunks of a chunked string have to be pushed before
+			if (*error == 0) {
+				return _extcss3_cleanup_tokenizer(*error = EXTCSS3_ERR_INV_PARAM, intern, true, true);
+			}
+
+			return EXTCSS3_FAILURE;
+		}
+	} while (EXTCSS3_TOKEN_TYPE(intern, token) != EXTCSS3_TYPE_EOF);
 
-	return _extcss3_cleanup_tokenizer(0, intern, false, true);
+	return EXTCSS3_SUCCESS;
 }
 
 /* ==================================================================================================== */
@@ -369,75 +220,197 @@ static inline bool _extcss3_cleanup_tokenizer(unsigned int error, extcss3_intern
 {
 	if (intern != NULL) {
 		if (token && (intern->base_token != NULL)) {
-			extcss3_release_tokens_list(intern->base_token);
-			intern->base_token = NULL;
+			extcss3_release_tokens_list(intern);
 		}
 
-		if (ctxt && (intern->base_ctxt != NULL)) {
-			extcss3_release_ctxts_list(intern->base_ctxt);
-			intern->base_ctxt = NULL;
+		// Keep the context stack allocated for the next run
+		if (ctxt) {
+			intern->last_ctxt = NULL;
 		}
 	}
 
 	return error == 0 ? EXTCSS3_SUCCESS : EXTCSS3_FAILURE;
 }
 
-static inline bool _extcss3_next_char(extcss3_intern *intern, unsigned int *error)
+static inline void _extcss3_next_char(extcss3_intern *intern)
 {
-	if (EXTCSS3_SUCCESS != extcss3_preprocess(intern, error)) {
-		return EXTCSS3_FAILURE;
-	} else if (*intern->state.reader != '\0') {
-		intern->state.reader += extcss3_char_len(*intern->state.reader);
+	while ((intern->state.rest > 0) && ((size_t)(intern->state.writer - intern->state.reader) < EXTCSS3_PREPROCESS_AHEAD)) {
+		extcss3_preprocess_move(intern);
+	}
+
+	if (*intern->state.reader != '\0') {
+		// Without any preprocessing the copy-string is the original string
+		if (intern->state.zero_copy && intern->state.is_ascii) {
+			intern->state.reader++;
+		} else {
+			intern->state.reader += extcss3_char_len(*intern->state.reader);
+		}
+	}
+}
+
+/**
+ * Move the reader over "len" preprocessed bytes at once
+ *
+ * At the end of the preprocessed bytes the reader may stop inside of a multibyte character. The next scan or
+ * _extcss3_next_char() (one byte per continuation byte) moves it on to the following character then.
+ */
+static inline void _extcss3_skip_bytes(extcss3_intern *intern, size_t len)
+{
+	intern->state.reader += len;
+
+	while ((intern->state.rest > 0) && ((size_t)(intern->state.writer - intern->state.reader) < EXTCSS3_PREPROCESS_AHEAD)) {
+		extcss3_preprocess_move(intern);
+	}
+}
+
+/**
+ * Move the reader over all whitespace at once
+ */
+static inline void _extcss3_skip_ws(extcss3_intern *intern)
+{
+	size_t len;
+
+	while ((len = extcss3_scan_ws(intern->state.reader, intern->state.writer - intern->state.reader)) > 0) {
+		_extcss3_skip_bytes(intern, len);
+	}
+}
+
+/**
+ * Move the new (last created) token to a reused slot in the "stream" mode, see extcss3_tokenizer_start()
+ */
+static inline extcss3_token *_extcss3_reuse_token(extcss3_intern *intern, extcss3_token *token)
+{
+	extcss3_token *slot, *last = intern->last_token;
+
+	if (last == NULL) {
+		return token;
+	} else if ((EXTCSS3_TOKEN_TYPE(intern, last) == EXTCSS3_TYPE_WS) || (EXTCSS3_TOKEN_TYPE(intern, last) == EXTCSS3_TYPE_COMMENT)) {
+		// Replace the last token, the new one follows the token in front of it
+		slot = last;
+		intern->last_token = EXTCSS3_TOKEN_PREV(intern, last);
+	} else if (last->prev != 0) {
+		// Replace the token in front of the last one
+		slot = EXTCSS3_TOKEN_PREV(intern, last);
+		last->prev = 0;
+	} else {
+		return token;
+	}
+
+	if (intern->last_token != NULL) {
+		intern->last_token->next = 0;
 	}
 
+	// The number of the token (if any) goes along by its index, see _extcss3_compact_numbers()
+	EXTCSS3_TOKEN_TYPE(intern, slot) = EXTCSS3_TOKEN_TYPE(intern, token);
+	*slot = *token;
+
+	intern->tokens_len--;
+
+	return slot;
+}
+
+/**
+ * Move the numbers of the kept tokens to the front in the "stream" mode, the numbers of reused slots are dropped
+ */
+static inline void _extcss3_compact_numbers(extcss3_intern *intern)
+{
+	extcss3_token *token;
+	size_t len = 1;
+
+	// The indices grow along the token list, so no number is overwritten before it is moved
+	for (token = intern->base_token; token != NULL; token = EXTCSS3_TOKEN_NEXT(intern, token)) {
+		if (EXTCSS3_TOKEN_NUMBER(intern, token) != NULL) {
+			intern->numbers[len] = *EXTCSS3_TOKEN_NUMBER(intern, token);
+			token->id = len++;
+		}
+	}
+
+	intern->numbers_len = len;
+}
+
+/**
+ * Remember the bytes of an escape before they are replaced, if the token may be consumed again later
+ */
+static inline bool _extcss3_save_patch(extcss3_intern *intern, const char *pos, size_t len, unsigned int *error)
+{
+	extcss3_patch *patches;
+	size_t size;
+
+	if (!intern->state.chunked || intern->state.finished) {
+		return EXTCSS3_SUCCESS;
+	}
+
+	if (intern->patches_len >= intern->patches_size) {
+		size = (intern->patches_size == 0) ? EXTCSS3_PATCHES_SIZE : (intern->patches_size * 2);
+
+		if ((patches = (extcss3_patch *)EXTCSS3_REALLOC(&intern->allocator, intern->patches, size * sizeof(extcss3_patch))) == NULL) {
+			*error = EXTCSS3_ERR_MEMORY;
+
+			return EXTCSS3_FAILURE;
+		}
+
+		intern->patches = patches;
+		intern->patches_size = size;
+	}
+
+	patches = intern->patches + intern->patches_len++;
+
+	patches->off = _EXTCSS3_OFFSET(intern, pos);
+	patches->len = EXTCSS3_REPLACEMENT_LEN;
+	patches->orig_len = len;
+
+	memcpy(patches->orig, pos, len);
+
 	return EXTCSS3_SUCCESS;
 }
 
-static inline bool _extcss3_token_add(extcss3_intern *intern, extcss3_token *token, unsigned int *error)
+/**
+ * Restore the replaced escapes of the dropped token in reverse order
+ */
+static inline void _extcss3_restore_patches(extcss3_intern *intern)
 {
-	extcss3_token *prev;
+	extcss3_patch *patch;
 
-	if ((token->prev = intern->last_token) != NULL) {
-		intern->last_token->next = token;
+	while (intern->patches_len > 0) {
+		patch = intern->patches + --intern->patches_len;
+
+		extcss3_preprocess_replace(intern, intern->copy.str + patch->off, patch->len, patch->orig, patch->orig_len);
+	}
+}
+
+static inline bool _extcss3_token_add(extcss3_intern *intern, extcss3_token *token, unsigned int *error)
+{
+	if ((token->prev = EXTCSS3_TOKEN_INDEX(intern, intern->last_token)) != 0) {
+		intern->last_token->next = EXTCSS3_TOKEN_INDEX(intern, token);
 	}
 
 	intern->last_token = token;
 
 	// Mark the first @import <string> token as an <url> token
-	if (token->type == EXTCSS3_TYPE_STRING) {
-		prev = token->prev;
-
-		while (prev != NULL) {
-			if ((prev->type == EXTCSS3_TYPE_WS) || (prev->type == EXTCSS3_TYPE_COMMENT)) {
-				prev = prev->prev;
-				continue;
-			} else if (prev->type != EXTCSS3_TYPE_AT_KEYWORD) {
-				break;
-			}
+	switch (EXTCSS3_TOKEN_TYPE(intern, token)) {
+		case EXTCSS3_TYPE_WS:
+		case EXTCSS3_TYPE_COMMENT:
+			break;
 
-			if (prev->data.len == 7 /* strlen("@import") */) {
-				if (EXTCSS3_SUCCESS == extcss3_ascii_strncasecmp(prev->data.str, "@import", 7)) {
-					token->type		= EXTCSS3_TYPE_URL;
-					token->flag		= EXTCSS3_FLAG_AT_URL_STRING;
-					token->info.str	= token->data.str;
-					token->info.len	= 1;
-				}
+		case EXTCSS3_TYPE_STRING:
+			if (intern->state.at_import) {
+				EXTCSS3_TOKEN_TYPE(intern, token)	= EXTCSS3_TYPE_URL;
+				token->flag							= EXTCSS3_FLAG_AT_URL_STRING;
+				token->info_len						= 1;
 			}
 
+			intern->state.at_import = false;
 			break;
-		}
+
+		default:
+			intern->state.at_import = (EXTCSS3_TOKEN_KEYWORD(intern, token) == EXTCSS3_KEYWORD_AT_IMPORT);
 	}
 
 	/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-	if (intern->base_ctxt != NULL) {
-		if (EXTCSS3_TYPE_IS_MODIFIABLE(token->type) && (intern->modifier.callback != NULL)) {
+	if (intern->last_ctxt != NULL) {
+		if (EXTCSS3_TYPE_IS_MODIFIABLE(EXTCSS3_TOKEN_TYPE(intern, token)) && (intern->modifier.callback != NULL)) {
 			intern->modifier.callback(intern);
-
-			if ((token->user.str != NULL) && (token->user.len > token->data.len)) {
-				intern->modifier.user_strlen_diff -= token->data.len;
-				intern->modifier.user_strlen_diff += token->user.len;
-			}
 		}
 
 		if (EXTCSS3_SUCCESS != extcss3_ctxt_update(intern, error)) {
@@ -453,6 +426,256 @@ static inline bool _extcss3_token_add(extcss3_intern *intern, extcss3_token *tok
 /* ==================================================================================================== */
 /* TOKEN FILLER */
 
+/**
+ * https://www.w3.org/TR/css-syntax-3/#consume-a-token
+ */
+static inline bool _extcss3_fill_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error)
+{
+	char *reader = intern->state.reader;
+
+	switch (*reader) {
+		case ' ':
+		case '\n':
+		case '\t':
+		{
+			_extcss3_fill_ws_token(intern, token);
+			break;
+		}
+		case '"':
+		case '\'':
+		{
+			if (EXTCSS3_SUCCESS != _extcss3_fill_string_token(intern, token, error)) {
+				return EXTCSS3_FAILURE;
+			}
+
+			break;
+		}
+		case '#':
+		{
+			if (
+				(EXTCSS3_SUCCESS == _extcss3_check_is_name(reader + 1)) ||
+				(EXTCSS3_SUCCESS == _extcss3_check_start_valid_escape(reader + 1))
+			) {
+				if (EXTCSS3_SUCCESS != _extcss3_fill_hash_token(intern, token, error)) {
+					return EXTCSS3_FAILURE;
+				}
+			} else {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_DELIM, 1);
+			}
+
+			break;
+		}
+		case '$':
+		{
+			if (reader[1] == '=') {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_SUFFIX_MATCH, 2);
+			} else {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_DELIM, 1);
+			}
+
+			break;
+		}
+		case '(':
+		{
+			_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_BR_RO, 1);
+			break;
+		}
+		case ')':
+		{
+			_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_BR_RC, 1);
+			break;
+		}
+		case '[':
+		{
+			_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_BR_SO, 1);
+			break;
+		}
+		case ']':
+		{
+			_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_BR_SC, 1);
+			break;
+		}
+		case '{':
+		{
+			_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_BR_CO, 1);
+			break;
+		}
+		case '}':
+		{
+			_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_BR_CC, 1);
+			break;
+		}
+		case ',':
+		{
+			_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_COMMA, 1);
+			break;
+		}
+		case ':':
+		{
+			_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_COLON, 1);
+			break;
+		}
+		case ';':
+		{
+			_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_SEMICOLON, 1);
+			break;
+		}
+		case '*':
+		{
+			if (reader[1] == '=') {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_SUBSTR_MATCH, 2);
+			} else {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_DELIM, 1);
+			}
+
+			break;
+		}
+		case '+':
+		case '.':
+		{
+			if (EXTCSS3_SUCCESS == _extcss3_check_start_number(reader)) {
+				if (EXTCSS3_SUCCESS != _extcss3_fill_number_token(intern, token, error)) {
+					return EXTCSS3_FAILURE;
+				}
+			} else {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_DELIM, 1);
+			}
+
+			break;
+		}
+		case '-':
+		{
+			if (EXTCSS3_SUCCESS == _extcss3_check_start_number(reader)) {
+				if (EXTCSS3_SUCCESS != _extcss3_fill_number_token(intern, token, error)) {
+					return EXTCSS3_FAILURE;
+				}
+			} else if (EXTCSS3_SUCCESS == _extcss3_check_start_ident(reader)) {
+				if (EXTCSS3_SUCCESS != _extcss3_fill_ident_like_token(intern, token, error)) {
+					return EXTCSS3_FAILURE;
+				}
+			} else if ((reader[1] == '-') && (reader[2] == '>')) {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_CDC, 3);
+			} else {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_DELIM, 1);
+			}
+
+			break;
+		}
+		case '/':
+		{
+			if (reader[1] == '*') {
+				_extcss3_fill_comment_token(intern, token);
+			} else {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_DELIM, 1);
+			}
+
+			break;
+		}
+		case '<':
+		{
+			if (reader[1] == '!' && reader[2] == '-' && reader[3] == '-') {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_CDO, 4);
+			} else {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_DELIM, 1);
+			}
+
+			break;
+		}
+		case '@':
+		{
+			if (EXTCSS3_SUCCESS == _extcss3_check_start_ident(reader + 1)) {
+				if (EXTCSS3_SUCCESS != _extcss3_fill_at_token(intern, token, error)) {
+					return EXTCSS3_FAILURE;
+				}
+			} else {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_DELIM, 1);
+			}
+
+			break;
+		}
+		case '\\':
+		{
+			if (EXTCSS3_SUCCESS == _extcss3_check_start_valid_escape(reader + 1)) {
+				if (EXTCSS3_SUCCESS != _extcss3_fill_ident_like_token(intern, token, error)) {
+					return EXTCSS3_FAILURE;
+				}
+			} else {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_DELIM, 1);
+			}
+
+			break;
+		}
+		case '^':
+		{
+			if (reader[1] == '=') {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_PREFIX_MATCH, 2);
+			} else {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_DELIM, 1);
+			}
+
+			break;
+		}
+		case '|':
+		{
+			if (reader[1] == '=') {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_DASH_MATCH, 2);
+			} else if (reader[1] == '|') {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_COLUMN, 2);
+			} else {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_DELIM, 1);
+			}
+
+			break;
+		}
+		case '~':
+		{
+			if (reader[1] == '=') {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_INCLUDE_MATCH, 2);
+			} else {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_DELIM, 1);
+			}
+
+			break;
+		}
+		case 'u':
+		case 'U':
+		{
+			if ((reader[1] == '+') && ((reader[2] == '?') || EXTCSS3_IS_HEX(reader[2]))) {
+				_extcss3_fill_unicode_range_token(intern, token);
+			} else {
+				if (EXTCSS3_SUCCESS != _extcss3_fill_ident_like_token(intern, token, error)) {
+					return EXTCSS3_FAILURE;
+				}
+			}
+
+			break;
+		}
+		case '\0':
+		{
+			_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_EOF, 1);
+			break;
+		}
+		default:
+		{
+			if (EXTCSS3_IS_DIGIT(*reader)) {
+				if (EXTCSS3_SUCCESS != _extcss3_fill_number_token(intern, token, error)) {
+					return EXTCSS3_FAILURE;
+				}
+			} else if (EXTCSS3_SUCCESS == _extcss3_check_start_name(reader)) {
+				if (EXTCSS3_SUCCESS != _extcss3_fill_ident_like_token(intern, token, error)) {
+					return EXTCSS3_FAILURE;
+				}
+			} else {
+				_extcss3_fill_fixed_token(intern, token, EXTCSS3_TYPE_DELIM, 1);
+			}
+
+			break;
+		}
+	}
+
+	return EXTCSS3_SUCCESS;
+}
+
 /**
  * Add one of the tokens with a fixed bytes length:
  * 
@@ -476,37 +699,31 @@ static inline bool _extcss3_token_add(extcss3_intern *intern, extcss3_token *tok
  * (1) EXTCSS3_TYPE_BR_CC
  * (1) EXTCSS3_TYPE_EOF
  */
-static inline bool _extcss3_fill_fixed_token(extcss3_intern *intern, extcss3_token *token, unsigned int type, unsigned int chars, unsigned int *error)
+static inline void _extcss3_fill_fixed_token(extcss3_intern *intern, extcss3_token *token, unsigned int type, unsigned int chars)
 {
-	token->type = type;
-	token->data.str = intern->state.reader;
+	EXTCSS3_TOKEN_TYPE(intern, token) = type;
+	token->data_off = _EXTCSS3_OFFSET(intern, intern->state.reader);
 
-	if (token->type != EXTCSS3_TYPE_EOF) {
+	if (EXTCSS3_TOKEN_TYPE(intern, token) != EXTCSS3_TYPE_EOF) {
 		while (chars--) {
-			_EXTCSS3_NEXT(intern, error);
+			_extcss3_next_char(intern);
 		}
 	}
 
-	token->data.len = intern->state.reader - token->data.str;
-
-	return EXTCSS3_SUCCESS;
+	token->data_len = intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token);
 }
 
 /**
  * https://www.w3.org/TR/css-syntax-3/#consume-a-token (whitespace)
  */
-static inline bool _extcss3_fill_ws_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error)
+static inline void _extcss3_fill_ws_token(extcss3_intern *intern, extcss3_token *token)
 {
-	token->type = EXTCSS3_TYPE_WS;
-	token->data.str = intern->state.reader;
+	EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_WS;
+	token->data_off = _EXTCSS3_OFFSET(intern, intern->state.reader);
 
-	while (EXTCSS3_IS_WS(*intern->state.reader)) {
-		_EXTCSS3_NEXT(intern, error);
-	}
+	_extcss3_skip_ws(intern);
 
-	token->data.len = intern->state.reader - token->data.str;
-
-	return EXTCSS3_SUCCESS;
+	token->data_len = intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token);
 }
 
 /**
@@ -514,9 +731,9 @@ static inline bool _extcss3_fill_ws_token(extcss3_intern *intern, extcss3_token
  */
 static inline bool _extcss3_fill_hash_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error)
 {
-	token->type = EXTCSS3_TYPE_HASH;
+	EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_HASH;
 	token->flag = EXTCSS3_FLAG_UNRESTRICTED;
-	token->data.str = intern->state.reader;
+	token->data_off = _EXTCSS3_OFFSET(intern, intern->state.reader);
 
 	if (EXTCSS3_SUCCESS == _extcss3_check_start_ident(intern->state.reader + 1)) {
 		token->flag = EXTCSS3_FLAG_ID;
@@ -526,7 +743,7 @@ static inline bool _extcss3_fill_hash_token(extcss3_intern *intern, extcss3_toke
 		return EXTCSS3_FAILURE;
 	}
 
-	token->data.len = intern->state.reader - token->data.str;
+	token->data_len = intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token);
 
 	return EXTCSS3_SUCCESS;
 }
@@ -536,14 +753,15 @@ static inline bool _extcss3_fill_hash_token(extcss3_intern *intern, extcss3_toke
  */
 static inline bool _extcss3_fill_at_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error)
 {
-	token->type = EXTCSS3_TYPE_AT_KEYWORD;
-	token->data.str = intern->state.reader;
+	EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_AT_KEYWORD;
+	token->data_off = _EXTCSS3_OFFSET(intern, intern->state.reader);
 
 	if (EXTCSS3_SUCCESS != _extcss3_consume_name(intern, error)) {
 		return EXTCSS3_FAILURE;
 	}
 
-	token->data.len = intern->state.reader - token->data.str;
+	token->data_len = intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token);
+	token->id = extcss3_get_keyword(EXTCSS3_TOKEN_DATA(intern, token), token->data_len);
 
 	return EXTCSS3_SUCCESS;
 }
@@ -551,46 +769,51 @@ static inline bool _extcss3_fill_at_token(extcss3_intern *intern, extcss3_token
 /**
  * https://www.w3.org/TR/css-syntax-3/#consume-a-token (U+002F SOLIDUS (/))
  */
-static inline bool _extcss3_fill_comment_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error)
+static inline void _extcss3_fill_comment_token(extcss3_intern *intern, extcss3_token *token)
 {
-	token->type = EXTCSS3_TYPE_COMMENT;
-	token->data.str = intern->state.reader;
+	EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_COMMENT;
+	token->data_off = _EXTCSS3_OFFSET(intern, intern->state.reader);
 
 	// Consume '/' and '*'
-	_EXTCSS3_NEXT(intern, error);
-	_EXTCSS3_NEXT(intern, error);
+	_extcss3_next_char(intern);
+	_extcss3_next_char(intern);
+
+	while (1) {
+		// Skip all bytes in front of the next '*' that may start the "*\/"
+		_extcss3_skip_bytes(intern, extcss3_scan_comment(intern->state.reader, intern->state.writer - intern->state.reader));
+
+		if ((*intern->state.reader == '\0') || ((*intern->state.reader == '*') && (intern->state.reader[1] == '/'))) {
+			break;
+		}
 
-	while ((*intern->state.reader != '\0') && ((*intern->state.reader != '*') || (intern->state.reader[1] != '/'))) {
-		_EXTCSS3_NEXT(intern, error);
+		_extcss3_next_char(intern);
 	}
 
 	// Consume '*' and '/'
 	if (*intern->state.reader != '\0') {
-		_EXTCSS3_NEXT(intern, error);
+		_extcss3_next_char(intern);
 
 		if (*intern->state.reader != '\0') {
-			_EXTCSS3_NEXT(intern, error);
+			_extcss3_next_char(intern);
 		}
 	}
 
-	token->data.len = intern->state.reader - token->data.str;
-
-	return EXTCSS3_SUCCESS;
+	token->data_len = intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token);
 }
 
 /**
  * https://www.w3.org/TR/css-syntax-3/#consume-a-unicode-range-token
  */
-static inline bool _extcss3_fill_unicode_range_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error)
+static inline void _extcss3_fill_unicode_range_token(extcss3_intern *intern, extcss3_token *token)
 {
 	unsigned int i, q;
 
-	token->type = EXTCSS3_TYPE_UNICODE_RANGE;
-	token->data.str = intern->state.reader;
+	EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_UNICODE_RANGE;
+	token->data_off = _EXTCSS3_OFFSET(intern, intern->state.reader);
 
 	// Consume 'U' and '+'
-	_EXTCSS3_NEXT(intern, error);
-	_EXTCSS3_NEXT(intern, error);
+	_extcss3_next_char(intern);
+	_extcss3_next_char(intern);
 
 	for (i = 0, q = 0; i < 6; i++) {
 		if (!EXTCSS3_IS_HEX(*intern->state.reader)) {
@@ -601,29 +824,27 @@ static inline bool _extcss3_fill_unicode_range_token(extcss3_intern *intern, ext
 			}
 		}
 
-		_EXTCSS3_NEXT(intern, error);
+		_extcss3_next_char(intern);
 	}
 
 	// While the standard would require us to interpret/decode the start and the end of
 	// the range, the string representation is good enough for now. We are not a parser.
 
 	if (q || (*intern->state.reader != '-') || !EXTCSS3_IS_HEX(intern->state.reader[1])) {
-		token->data.len = intern->state.reader - token->data.str;
+		token->data_len = intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token);
 	} else {
-		_EXTCSS3_NEXT(intern, error);
+		_extcss3_next_char(intern);
 
 		for (i = 0; i < 6; i++) {
 			if (!EXTCSS3_IS_HEX(*intern->state.reader)) {
 				break;
 			}
 
-			_EXTCSS3_NEXT(intern, error);
+			_extcss3_next_char(intern);
 		}
 
-		token->data.len = intern->state.reader - token->data.str;
+		token->data_len = intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token);
 	}
-
-	return EXTCSS3_SUCCESS;
 }
 
 /**
@@ -631,7 +852,7 @@ static inline bool _extcss3_fill_unicode_range_token(extcss3_intern *intern, ext
  */
 static inline bool _extcss3_fill_ident_like_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error)
 {
-	token->data.str = intern->state.reader;
+	token->data_off = _EXTCSS3_OFFSET(intern, intern->state.reader);
 
 	if (EXTCSS3_SUCCESS != _extcss3_consume_name(intern, error)) {
 		return EXTCSS3_FAILURE;
@@ -639,22 +860,24 @@ static inline bool _extcss3_fill_ident_like_token(extcss3_intern *intern, extcss
 
 	if (*intern->state.reader == '(') {
 		if (
-			((intern->state.reader - token->data.str) == 3) &&
-			EXTCSS3_CHARS_EQ(token->data.str[0], 'u') &&
-			EXTCSS3_CHARS_EQ(token->data.str[1], 'r') &&
-			EXTCSS3_CHARS_EQ(token->data.str[2], 'l')
+			((intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token)) == 3) &&
+			EXTCSS3_CHARS_EQ(EXTCSS3_TOKEN_DATA(intern, token)[0], 'u') &&
+			EXTCSS3_CHARS_EQ(EXTCSS3_TOKEN_DATA(intern, token)[1], 'r') &&
+			EXTCSS3_CHARS_EQ(EXTCSS3_TOKEN_DATA(intern, token)[2], 'l')
 		) {
 			return _extcss3_fill_url_token(intern, token, error);
 		} else {
-			token->type = EXTCSS3_TYPE_FUNCTION;
-			token->data.len = intern->state.reader - token->data.str;
+			EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_FUNCTION;
+			token->data_len = intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token);
+			token->id = extcss3_get_keyword(EXTCSS3_TOKEN_DATA(intern, token), token->data_len);
 
 			// Consume the '(' after the function name
-			_EXTCSS3_NEXT(intern, error);
+			_extcss3_next_char(intern);
 		}
 	} else {
-		token->type = EXTCSS3_TYPE_IDENT;
-		token->data.len = intern->state.reader - token->data.str;
+		EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_IDENT;
+		token->data_len = intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token);
+		token->id = extcss3_get_keyword(EXTCSS3_TOKEN_DATA(intern, token), token->data_len);
 	}
 
 	return EXTCSS3_SUCCESS;
@@ -665,81 +888,84 @@ static inline bool _extcss3_fill_ident_like_token(extcss3_intern *intern, extcss
  */
 static inline bool _extcss3_fill_url_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error)
 {
-	extcss3_token tmp;
+	uint32_t data_off;
 
 	// Consume the '(' after "url"
-	_EXTCSS3_NEXT(intern, error);
+	_extcss3_next_char(intern);
 
 	// Consume all leading whitespace
-	while (EXTCSS3_IS_WS(*intern->state.reader)) {
-		_EXTCSS3_NEXT(intern, error);
-	}
+	_extcss3_skip_ws(intern);
 
-	token->type = EXTCSS3_TYPE_URL;
-	token->data.str = intern->state.reader;
+	EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_URL;
+	token->data_off = _EXTCSS3_OFFSET(intern, intern->state.reader);
 
 	if (*intern->state.reader == '\0') {
-		token->data.len = 0;
+		token->data_len = 0;
 	} else if ((*intern->state.reader == '"') || (*intern->state.reader == '\'')) {
-		if (EXTCSS3_SUCCESS != _extcss3_fill_string_token(intern, &tmp, error)) {
+		data_off = token->data_off;
+
+		// Consume the string into the token itself and turn it into an <url> token afterwards
+		if (EXTCSS3_SUCCESS != _extcss3_fill_string_token(intern, token, error)) {
 			return EXTCSS3_FAILURE;
 		}
 
-		if (tmp.type == EXTCSS3_TYPE_BAD_STRING) {
-			token->type = EXTCSS3_TYPE_BAD_URL;
+		if (EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_BAD_STRING) {
+			EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_BAD_URL;
+
+			token->data_off = data_off;
+			token->flag = EXTCSS3_UNDEFINED;
+			token->info_len = 0;
 
 			if (EXTCSS3_SUCCESS != _extcss3_consume_bad_url_remnants(intern, error)) {
 				return EXTCSS3_FAILURE;
 			}
 
-			token->data.len = intern->state.reader - token->data.str;
+			token->data_len = intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token);
 		} else {
-			token->data.str = tmp.data.str;
-			token->data.len = tmp.data.len;
-
-			token->flag = EXTCSS3_FLAG_STRING;
-			token->info.str = token->data.str;
-			token->info.len = 1;
+			EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_URL;
 
 			// Consume all trailing whitespace
-			while (EXTCSS3_IS_WS(*intern->state.reader)) {
-				_EXTCSS3_NEXT(intern, error);
-			}
+			_extcss3_skip_ws(intern);
 
 			if ((*intern->state.reader == ')') || (*intern->state.reader == '\0')) {
-				_EXTCSS3_NEXT(intern, error);
+				_extcss3_next_char(intern);
 			} else {
-				token->type = EXTCSS3_TYPE_BAD_URL;
+				EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_BAD_URL;
 
 				if (EXTCSS3_SUCCESS != _extcss3_consume_bad_url_remnants(intern, error)) {
 					return EXTCSS3_FAILURE;
 				}
 
-				token->data.len = intern->state.reader - token->data.str;
+				token->data_len = intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token);
 			}
 		}
 	} else {
 		while (1) {
-			token->data.len = intern->state.reader - token->data.str;
+			// Skip all bytes in front of the next one that may end the url
+			_extcss3_skip_bytes(intern, extcss3_scan_url(intern->state.reader, intern->state.writer - intern->state.reader));
+
+			token->data_len = intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token);
 
 			if ((*intern->state.reader == ')') || (*intern->state.reader == '\0')) {
-				return _extcss3_next_char(intern, error);
+				_extcss3_next_char(intern);
+
+				return EXTCSS3_SUCCESS;
 			} else if (EXTCSS3_IS_WS(*intern->state.reader)) {
 				// Consume all trailing whitespace
-				while (EXTCSS3_IS_WS(*intern->state.reader)) {
-					_EXTCSS3_NEXT(intern, error);
-				}
+				_extcss3_skip_ws(intern);
 
 				if ((*intern->state.reader == ')') || (*intern->state.reader == '\0')) {
-					return _extcss3_next_char(intern, error);
+					_extcss3_next_char(intern);
+
+					return EXTCSS3_SUCCESS;
 				} else {
-					token->type = EXTCSS3_TYPE_BAD_URL;
+					EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_BAD_URL;
 
 					if (EXTCSS3_SUCCESS != _extcss3_consume_bad_url_remnants(intern, error)) {
 						return EXTCSS3_FAILURE;
 					}
 
-					token->data.len = intern->state.reader - token->data.str;
+					token->data_len = intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token);
 
 					return EXTCSS3_SUCCESS;
 				}
@@ -749,13 +975,13 @@ static inline bool _extcss3_fill_url_token(extcss3_intern *intern, extcss3_token
 				(*intern->state.reader == '(')	||
 				EXTCSS3_NON_PRINTABLE(*intern->state.reader)
 			) {
-				token->type = EXTCSS3_TYPE_BAD_URL;
+				EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_BAD_URL;
 
 				if (EXTCSS3_SUCCESS != _extcss3_consume_bad_url_remnants(intern, error)) {
 					return EXTCSS3_FAILURE;
 				}
 
-				token->data.len = intern->state.reader - token->data.str;
+				token->data_len = intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token);
 
 				return EXTCSS3_SUCCESS;
 			} else if (*intern->state.reader == '\\') {
@@ -764,18 +990,18 @@ static inline bool _extcss3_fill_url_token(extcss3_intern *intern, extcss3_token
 						return EXTCSS3_FAILURE;
 					}
 				} else {
-					token->type = EXTCSS3_TYPE_BAD_URL;
+					EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_BAD_URL;
 
 					if (EXTCSS3_SUCCESS != _extcss3_consume_bad_url_remnants(intern, error)) {
 						return EXTCSS3_FAILURE;
 					}
 
-					token->data.len = intern->state.reader - token->data.str;
+					token->data_len = intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token);
 
 					return EXTCSS3_SUCCESS;
 				}
 			} else {
-				_EXTCSS3_NEXT(intern, error);
+				_extcss3_next_char(intern);
 			}
 		}
 	}
@@ -791,33 +1017,35 @@ static inline bool _extcss3_fill_string_token(extcss3_intern *intern, extcss3_to
 	char *tmp = intern->state.reader;
 
 	// Consume the opening '"' or '\''
-	_EXTCSS3_NEXT(intern, error);
+	_extcss3_next_char(intern);
 
-	token->type = EXTCSS3_TYPE_STRING;
+	EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_STRING;
 	token->flag = EXTCSS3_FLAG_STRING;
-	token->info.str = tmp;
-	token->info.len = 1;
+	token->info_len = 1;
 
 	while (true) {
+		// Skip all bytes in front of the next quote, '\\' or '\n'
+		_extcss3_skip_bytes(intern, extcss3_scan_string(intern->state.reader, intern->state.writer - intern->state.reader, *tmp));
+
 		if ((*intern->state.reader == *tmp) || (*intern->state.reader == '\0')) {
 			if (*intern->state.reader != '\0') {
 				// Consume the closing '"' or '\''
-				_EXTCSS3_NEXT(intern, error);
+				_extcss3_next_char(intern);
 			}
 
 			break;
 		} else if (*intern->state.reader == '\n') {
-			token->type = EXTCSS3_TYPE_BAD_STRING;
+			EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_BAD_STRING;
 
 			break;
 		} else if (*intern->state.reader == '\\') {
 			if (intern->state.reader[1] == '\0') {
 				// Consume the '\\'
-				_EXTCSS3_NEXT(intern, error);
+				_extcss3_next_char(intern);
 
 				break;
 			} else if (intern->state.reader[1] == '\n') {
-				_EXTCSS3_NEXT(intern, error);
+				_extcss3_next_char(intern);
 			} else if (EXTCSS3_SUCCESS == _extcss3_check_start_valid_escape(intern->state.reader)) {
 				if (EXTCSS3_SUCCESS != _extcss3_consume_escaped(intern, error)) {
 					return EXTCSS3_FAILURE;
@@ -827,11 +1055,11 @@ static inline bool _extcss3_fill_string_token(extcss3_intern *intern, extcss3_to
 			}
 		}
 
-		_EXTCSS3_NEXT(intern, error);
+		_extcss3_next_char(intern);
 	}
 
-	token->data.str = tmp;
-	token->data.len = intern->state.reader - tmp;
+	token->data_off = _EXTCSS3_OFFSET(intern, tmp);
+	token->data_len = intern->state.reader - tmp;
 
 	return EXTCSS3_SUCCESS;
 }
@@ -841,72 +1069,104 @@ static inline bool _extcss3_fill_string_token(extcss3_intern *intern, extcss3_to
  */
 static inline bool _extcss3_fill_number_token(extcss3_intern *intern, extcss3_token *token, unsigned int *error)
 {
+	extcss3_number *number, unused;
+	int64_t shift = 0, exponent = 0;
+	char *info, sign;
+
+	if (intern->numbers_len > EXTCSS3_NUMBERS_MAX) {
+		// Without an index left the number is parsed but not kept, the minifier keeps the digits then
+		number = (extcss3_number *)memset(&unused, 0, sizeof(extcss3_number));
+	} else if ((number = extcss3_create_number(intern, token)) == NULL) {
+		*error = EXTCSS3_ERR_MEMORY;
+
+		return EXTCSS3_FAILURE;
+	}
+
 	token->flag = EXTCSS3_FLAG_INTEGER;
-	token->data.str = intern->state.reader;
+	token->data_off = _EXTCSS3_OFFSET(intern, intern->state.reader);
 
 	if ((*intern->state.reader == '+') || (*intern->state.reader == '-')) {
-		_EXTCSS3_NEXT(intern, error);
+		number->sign = *intern->state.reader;
+
+		_extcss3_next_char(intern);
 	}
 
 	while (EXTCSS3_IS_DIGIT(*intern->state.reader)) {
-		_EXTCSS3_NEXT(intern, error);
+		extcss3_number_add_digit(number, *intern->state.reader, false, &shift);
+
+		_extcss3_next_char(intern);
 	}
 
 	if ((*intern->state.reader == '.') && EXTCSS3_IS_DIGIT(intern->state.reader[1])) {
-		_EXTCSS3_NEXT(intern, error);
+		_extcss3_next_char(intern);
 
 		token->flag = EXTCSS3_FLAG_NUMBER;
 
 		while (EXTCSS3_IS_DIGIT(*intern->state.reader)) {
-			_EXTCSS3_NEXT(intern, error);
+			extcss3_number_add_digit(number, *intern->state.reader, true, &shift);
+
+			_extcss3_next_char(intern);
 		}
 	}
 
 	if (EXTCSS3_CHARS_EQ(*intern->state.reader, 'e')) {
-		if (EXTCSS3_IS_DIGIT(intern->state.reader[1])) {
-			_EXTCSS3_NEXT(intern, error);
+		sign = '+';
 
-			token->flag = EXTCSS3_FLAG_NUMBER;
-
-			while (EXTCSS3_IS_DIGIT(*intern->state.reader)) {
-				_EXTCSS3_NEXT(intern, error);
-			}
+		if (EXTCSS3_IS_DIGIT(intern->state.reader[1])) {
+			_extcss3_next_char(intern);
 		} else if ((((intern->state.reader[1] == '+') || (intern->state.reader[1] == '-'))) && EXTCSS3_IS_DIGIT(intern->state.reader[2])) {
-			_EXTCSS3_NEXT(intern, error);
-			_EXTCSS3_NEXT(intern, error);
+			sign = intern->state.reader[1];
 
+			_extcss3_next_char(intern);
+			_extcss3_next_char(intern);
+		} else {
+			sign = '\0';
+		}
+
+		if (sign) {
 			token->flag = EXTCSS3_FLAG_NUMBER;
+			number->scientific = true;
 
 			while (EXTCSS3_IS_DIGIT(*intern->state.reader)) {
-				_EXTCSS3_NEXT(intern, error);
+				// Out of range anyway, but must not overflow
+				if (exponent <= EXTCSS3_NUMBER_EXPONENT_MAX) {
+					exponent = (exponent * 10) + (*intern->state.reader - '0');
+				}
+
+				_extcss3_next_char(intern);
 			}
 		}
+
+		if (sign == '-') {
+			exponent = -exponent;
+		}
 	}
 
-	// !!! The conversion to a number is intentionally skipped !!!
+	// The value is taken from the digits once, the minifier works on the parsed number only
+	extcss3_number_finish(number, shift + exponent);
 
 	if (*intern->state.reader == '%') {
-		token->type = EXTCSS3_TYPE_PERCENTAGE;
-		token->info.str = intern->state.reader;
+		EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_PERCENTAGE;
+		info = intern->state.reader;
 
 		// Consume the '%'
-		_EXTCSS3_NEXT(intern, error);
+		_extcss3_next_char(intern);
 
-		token->info.len = intern->state.reader - token->info.str;
+		token->info_len = intern->state.reader - info;
 	} else if (EXTCSS3_SUCCESS == _extcss3_check_start_ident(intern->state.reader)) {
-		token->type = EXTCSS3_TYPE_DIMENSION;
-		token->info.str = intern->state.reader;
+		EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_DIMENSION;
+		info = intern->state.reader;
 
 		if (EXTCSS3_SUCCESS != _extcss3_consume_name(intern, error)) {
 			return EXTCSS3_FAILURE;
 		}
 
-		token->info.len = intern->state.reader - token->info.str;
+		token->info_len = intern->state.reader - info;
 	} else {
-		token->type = EXTCSS3_TYPE_NUMBER;
+		EXTCSS3_TOKEN_TYPE(intern, token) = EXTCSS3_TYPE_NUMBER;
 	}
 
-	token->data.len = intern->state.reader - token->data.str;
+	token->data_len = intern->state.reader - EXTCSS3_TOKEN_DATA(intern, token);
 
 	return EXTCSS3_SUCCESS;
 }
@@ -921,16 +1181,15 @@ static inline bool _extcss3_consume_escaped(extcss3_intern *intern, unsigned int
 {
 	unsigned int i, v;
 	char hex[7];
-	char *reader_start, *writer_start;
-
-	reader_start = intern->state.reader;
-	writer_start = intern->state.writer;
+	char *reader_start = intern->state.reader;
 
 	// Consume '\\'
-	if (EXTCSS3_SUCCESS != _extcss3_next_char(intern, error)) {
-		return EXTCSS3_FAILURE;
-	} else if (!EXTCSS3_IS_HEX(*intern->state.reader)) {
-		return _extcss3_next_char(intern, error);
+	_extcss3_next_char(intern);
+
+	if (!EXTCSS3_IS_HEX(*intern->state.reader)) {
+		_extcss3_next_char(intern);
+
+		return EXTCSS3_SUCCESS;
 	}
 
 	for (i = 0; i < 6; i++) {
@@ -940,13 +1199,13 @@ static inline bool _extcss3_consume_escaped(extcss3_intern *intern, unsigned int
 
 		hex[i] = *intern->state.reader;
 
-		_EXTCSS3_NEXT(intern, error);
+		_extcss3_next_char(intern);
 	}
 
 	hex[i] = '\0';
 
 	if (EXTCSS3_IS_WS(*intern->state.reader)) {
-		_EXTCSS3_NEXT(intern, error);
+		_extcss3_next_char(intern);
 
 		i++;
 	}
@@ -956,11 +1215,13 @@ static inline bool _extcss3_consume_escaped(extcss3_intern *intern, unsigned int
 	if ((v <= 0) || (v > EXTCSS3_MAX_ALLOWED_CP) || EXTCSS3_FOR_SURROGATE_CP(v)) {
 		i++; // The '\\' has to be removed, too
 
+		if (EXTCSS3_SUCCESS != _extcss3_save_patch(intern, reader_start, intern->state.reader - reader_start, error)) {
+			return EXTCSS3_FAILURE;
+		}
+
 		if (i != EXTCSS3_REPLACEMENT_LEN) {
-			memmove(reader_start + EXTCSS3_REPLACEMENT_LEN, intern->state.reader, intern->state.writer - intern->state.reader + 1);
-			memcpy(reader_start, EXTCSS3_REPLACEMENT_CHR, EXTCSS3_REPLACEMENT_LEN);
+			extcss3_preprocess_replace(intern, reader_start, intern->state.reader - reader_start, EXTCSS3_REPLACEMENT_CHR, EXTCSS3_REPLACEMENT_LEN);
 
-			intern->state.writer = writer_start + EXTCSS3_REPLACEMENT_LEN;
 			intern->state.reader = reader_start + EXTCSS3_REPLACEMENT_LEN;
 		} else {
 			memcpy(reader_start, EXTCSS3_REPLACEMENT_CHR, EXTCSS3_REPLACEMENT_LEN);
@@ -976,10 +1237,12 @@ static inline bool _extcss3_consume_escaped(extcss3_intern *intern, unsigned int
 static inline bool _extcss3_consume_bad_url_remnants(extcss3_intern *intern, unsigned int *error)
 {
 	while (true) {
-		_EXTCSS3_NEXT(intern, error);
+		_extcss3_next_char(intern);
 
 		if ((*intern->state.reader == ')') || (*intern->state.reader == '\0')) {
-			return _extcss3_next_char(intern, error);
+			_extcss3_next_char(intern);
+
+			return EXTCSS3_SUCCESS;
 		} else if (EXTCSS3_SUCCESS == _extcss3_check_start_valid_escape(intern->state.reader)) {
 			if (EXTCSS3_SUCCESS != _extcss3_consume_escaped(intern, error)) {
 				return EXTCSS3_FAILURE;
@@ -996,7 +1259,10 @@ static inline bool _extcss3_consume_bad_url_remnants(extcss3_intern *intern, uns
 static inline bool _extcss3_consume_name(extcss3_intern *intern, unsigned int *error)
 {
 	while (true) {
-		_EXTCSS3_NEXT(intern, error);
+		_extcss3_next_char(intern);
+
+		// Skip all following name code points at once, the scan stops in front of escapes
+		_extcss3_skip_bytes(intern, extcss3_scan_name(intern->state.reader, intern->state.writer - intern->state.reader));
 
 		if (EXTCSS3_SUCCESS == _extcss3_check_is_name(intern->state.reader)) {
 			continue;
@@ -1036,11 +1302,7 @@ static inline bool _extcss3_check_start_valid_escape(const char *str)
  */
 static inline bool _extcss3_check_start_name(const char *str)
 {
-	if ((*str == '_') || EXTCSS3_IS_LETTER(*str) || EXTCSS3_IS_NON_ASCII(*str)) {
-		return EXTCSS3_SUCCESS;
-	}
-
-	return EXTCSS3_FAILURE;
+	return EXTCSS3_IS_NAME_START(*str);
 }
 
 /**
@@ -1094,9 +1356,5 @@ static inline bool _extcss3_check_start_number(const char *str)
  */
 static inline bool _extcss3_check_is_name(const char *str)
 {
-	if ((EXTCSS3_SUCCESS == _extcss3_check_start_name(str)) || EXTCSS3_IS_DIGIT(*str) || (*str == '-')) {
-		return EXTCSS3_SUCCESS;
-	}
-
-	return EXTCSS3_FAILURE;
+	return EXTCSS3_IS_NAME(*str);
 }
@@ -5,6 +5,9 @@
 
 /* ==================================================================================================== */
 
+bool extcss3_tokenizer_start(extcss3_intern *intern, bool stream, unsigned int *error);
+extcss3_token *extcss3_next_token(extcss3_intern *intern, unsigned int *error);
+
 bool extcss3_tokenize(extcss3_intern *intern, unsigned int *error);
 
 #endif /* EXTCSS3_TOKENIZER_H */
@@ -2,6 +2,7 @@
 #define EXTCSS3_TYPES_H
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <stdbool.h>
 
 /* ==================================================================================================== */
@@ -23,6 +24,13 @@
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+#define EXTCSS3_CONSTS_SIZE				((unsigned int)64)
+
+/* Maximum number of bytes of an incomplete character (and a '\r') held back until the next chunk */
+#define EXTCSS3_TAIL_SIZE				((unsigned int)8)
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
 #define EXTCSS3_FLAG_ID					((unsigned int)1)
 #define EXTCSS3_FLAG_UNRESTRICTED		((unsigned int)2)
 #define EXTCSS3_FLAG_INTEGER			((unsigned int)3)
@@ -115,18 +123,32 @@
 #pragma pack(push)
 #pragma pack()
 
+typedef struct _extcss3_allocator	extcss3_allocator;
+
 typedef struct _extcss3_str		extcss3_str;
 
+typedef struct _extcss3_chunk	extcss3_chunk;
+
+typedef struct _extcss3_arena	extcss3_arena;
+
 typedef struct _extcss3_state	extcss3_state;
 
 typedef struct _extcss3_token	extcss3_token;
 
+typedef struct _extcss3_number	extcss3_number;
+
 typedef struct _extcss3_ctxt	extcss3_ctxt;
 
+typedef struct _extcss3_patch	extcss3_patch;
+
+typedef struct _extcss3_const	extcss3_const;
+
 typedef struct _extcss3_vendor	extcss3_vendor;
 
 typedef struct _extcss3_mod		extcss3_mod;
 
+typedef struct _extcss3_output	extcss3_output;
+
 typedef struct _extcss3_decl	extcss3_decl;
 
 typedef struct _extcss3_block	extcss3_block;
@@ -137,42 +159,142 @@ typedef struct _extcss3_intern	extcss3_intern;
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+struct _extcss3_allocator
+{
+	void				*(*malloc)(void *data, size_t size);
+	void				*(*realloc)(void *data, void *ptr, size_t size);
+	void				(*free)(void *data, void *ptr);
+
+	/* Passed through to the functions above, e.g. for a custom arena */
+	void				*data;
+};
+
 struct _extcss3_str
 {
 	char				*str;
 	size_t				len;
 };
 
+struct _extcss3_chunk
+{
+	extcss3_chunk		*next;
+
+	size_t				size;
+	size_t				used;
+
+	char				data[];
+};
+
+struct _extcss3_arena
+{
+	const extcss3_allocator	*allocator;
+
+	extcss3_chunk		*base;
+	extcss3_chunk		*curr;
+};
+
 struct _extcss3_state
 {
+	/* The tokenizer position, the normalized bytes behind the gap and the end of the bytes in place */
 	char				*reader;
 	char				*cursor;
 	char				*writer;
 
+	/* The number of normalized bytes behind the gap */
 	size_t				rest;
+
+	bool				zero_copy;
+
+	/* The original string contains no multibyte character, see extcss3_check_bytes_corruption() */
+	bool				is_ascii;
+
+	/* Only the last tokens are kept, see extcss3_tokenizer_start() */
+	bool				stream;
+
+	/* The css string is pushed in chunks, see extcss3_push_css_chunk() */
+	bool				chunked;
+	bool				finished;
+
+	/* The last token that is no whitespace or comment is "@import", see _extcss3_token_add() */
+	bool				at_import;
+
+	/* The number of bytes the next try of a dropped token needs in front of the reader, see extcss3_next_token() */
+	size_t				ahead;
+
+	/* The number of '\\' in front of the writer, each escape may grow by one byte, see extcss3_push_css_chunk() */
+	size_t				escapes;
+
+	/* The bytes at the end of the last chunk that are held back for the next one */
+	char				tail[EXTCSS3_TAIL_SIZE];
+	size_t				tail_len;
 };
 
 struct _extcss3_token
 {
-	unsigned int		type;
+	/* The type is kept in the dense type array of the intern, see EXTCSS3_TOKEN_TYPE() */
+	uint32_t			flag : 8;
+
+	/**
+	 * The keyword ID of <ident>, <function> and <at-keyword> tokens (see EXTCSS3_TOKEN_KEYWORD()), or the index into
+	 * the numbers of the intern of <number>, <percentage> and <dimension> tokens (see EXTCSS3_TOKEN_NUMBER())
+	 */
+	uint32_t			id : 24;
+
+	/* The <info> string is the first byte of <data> for quoted strings, otherwise the end of <data> */
+	uint32_t			info_len;
 
-	extcss3_str			data;
-	extcss3_str			info;
-	extcss3_str			user;
+	/* Offset into the copy-string of the intern */
+	uint32_t			data_off;
+	uint32_t			data_len;
 
-	extcss3_token		*prev;
-	extcss3_token		*next;
+	/* Offset into the user strings of the intern, 0 for no user string */
+	uint32_t			user_off;
+	uint32_t			user_len;
 
-	unsigned int		flag;
+	/* Index into the token array of the intern, 0 for no token */
+	uint32_t			prev;
+	uint32_t			next;
+};
+
+struct _extcss3_number
+{
+	/* The value is <sign> <mantissa> * 10^<exponent>, the mantissa has no trailing '0' digits */
+	uint64_t			mantissa;
+	int32_t				exponent;
+
+	/* The sign as given in the css string ('+', '-' or '\0') */
+	char				sign;
+
+	/* Number of digits of the mantissa, 0 for zero */
+	uint8_t				digits;
+
+	/* The number was given with an exponent ("1e3") */
+	bool				scientific;
+
+	/* Digits other than '0' were dropped or the exponent was out of range, see EXTCSS3_NUMBER_DIGITS */
+	bool				inexact;
 };
 
 struct _extcss3_ctxt
 {
 	size_t				level;
-	extcss3_token		*token;
+	uint32_t			token;
+};
 
-	extcss3_ctxt		*prev;
-	extcss3_ctxt		*next;
+struct _extcss3_patch
+{
+	/* Offset into the copy-string, the length of the replacement and the replaced bytes of the escape */
+	uint32_t			off;
+	uint32_t			len;
+	uint32_t			orig_len;
+	char				orig[8];
+};
+
+struct _extcss3_const
+{
+	const char			*str;
+	uint32_t			off;
+	uint32_t			len;
 };
 
 struct _extcss3_vendor
@@ -191,8 +313,14 @@ struct _extcss3_mod
 
 	void				(*callback)(extcss3_intern *intern);
 	void				(*destructor)(void *modifier);
+};
 
-	long long			user_strlen_diff;
+struct _extcss3_output
+{
+	void				*buffer;
+	size_t				len;
+
+	char				*(*alloc)(extcss3_intern *intern, size_t size);
 };
 
 struct _extcss3_decl
@@ -228,21 +356,56 @@ struct _extcss3_rule
 
 struct _extcss3_intern
 {
+	/* Every buffer of the intern (and the intern itself) is allocated by this allocator */
+	extcss3_allocator	allocator;
+
 	extcss3_state		state;
 
 	extcss3_str			orig;
 	extcss3_str			copy;
+	extcss3_str			buffer;
+
+	extcss3_arena		rule_arena;
+	extcss3_arena		block_arena;
+	extcss3_arena		decl_arena;
+
+	size_t				high_water;
+
+	extcss3_token		*tokens;
+	uint8_t				*types;
+	size_t				tokens_len;
+	size_t				tokens_size;
+
+	/* Only the numeric tokens take a number, see extcss3_create_number() */
+	extcss3_number		*numbers;
+	size_t				numbers_len;
+	size_t				numbers_size;
+
+	char				*strings;
+	size_t				strings_len;
+	size_t				strings_size;
+
+	/* Static strings already copied to the user strings, see extcss3_set_user_const() */
+	extcss3_const		consts[EXTCSS3_CONSTS_SIZE];
 
 	extcss3_token		*base_token;
 	extcss3_token		*last_token;
 
 	extcss3_ctxt		*base_ctxt;
 	extcss3_ctxt		*last_ctxt;
+	size_t				ctxt_size;
+
+	/* The escapes replaced while consuming the current token, see extcss3_next_token() */
+	extcss3_patch		*patches;
+	size_t				patches_len;
+	size_t				patches_size;
 
 	extcss3_vendor		*base_vendor;
 	extcss3_vendor		*last_vendor;
 
 	extcss3_mod			modifier;
+
+	extcss3_output		output;
 };
 
 #pragma pack(pop)
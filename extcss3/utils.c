@@ -2,6 +2,48 @@
 
 /* ==================================================================================================== */
 
+#define _X	(0)
+#define _W	(EXTCSS3_CC_WS)
+#define _P	(EXTCSS3_CC_NON_PRINTABLE)
+#define _D	(EXTCSS3_CC_DIGIT | EXTCSS3_CC_HEX | EXTCSS3_CC_NAME)
+#define _H	(EXTCSS3_CC_LETTER | EXTCSS3_CC_HEX | EXTCSS3_CC_NAME_START | EXTCSS3_CC_NAME)
+#define _L	(EXTCSS3_CC_LETTER | EXTCSS3_CC_NAME_START | EXTCSS3_CC_NAME)
+#define _M	(EXTCSS3_CC_NAME)
+#define _N	(EXTCSS3_CC_NAME_START | EXTCSS3_CC_NAME)
+
+/**
+ * The character classes of all bytes, the bytes of the non-ASCII characters are name code points
+ */
+const uint8_t extcss3_char_class[256] = {
+	/* 0x00 */	_P, _P, _P, _P, _P, _P, _P, _P, _P, _W, _W, _P, _X, _X, _P, _P,
+	/* 0x10 */	_P, _P, _P, _P, _P, _P, _P, _P, _P, _P, _P, _P, _P, _P, _P, _P,
+	/* 0x20 */	_W, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _X, _M, _X, _X,
+	/* 0x30 */	_D, _D, _D, _D, _D, _D, _D, _D, _D, _D, _X, _X, _X, _X, _X, _X,
+	/* 0x40 */	_X, _H, _H, _H, _H, _H, _H, _L, _L, _L, _L, _L, _L, _L, _L, _L,
+	/* 0x50 */	_L, _L, _L, _L, _L, _L, _L, _L, _L, _L, _L, _X, _X, _X, _X, _N,
+	/* 0x60 */	_X, _H, _H, _H, _H, _H, _H, _L, _L, _L, _L, _L, _L, _L, _L, _L,
+	/* 0x70 */	_L, _L, _L, _L, _L, _L, _L, _L, _L, _L, _L, _X, _X, _X, _X, _P,
+	/* 0x80 */	_N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N,
+	/* 0x90 */	_N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N,
+	/* 0xA0 */	_N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N,
+	/* 0xB0 */	_N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N,
+	/* 0xC0 */	_N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N,
+	/* 0xD0 */	_N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N,
+	/* 0xE0 */	_N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N,
+	/* 0xF0 */	_N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N, _N
+};
+
+#undef _X
+#undef _W
+#undef _P
+#undef _D
+#undef _H
+#undef _L
+#undef _M
+#undef _N
+
+/* ==================================================================================================== */
+
 /**
  * Return the size of the given (UTF-8 multibyte) character in bytes
  */
@@ -137,3 +179,19 @@ char *extcss3_get_flag_str(unsigned int flag)
 			return EXTCSS3_UNDEFINED_STR;
 	}
 }
+
+#if defined(EXTCSS3_HAVE_AVX2)
+/**
+ * Check once whether the CPU supports the AVX2 instructions
+ */
+bool extcss3_cpu_has_avx2(void)
+{
+	static int avx2 = -1;
+
+	if (avx2 < 0) {
+		avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+	}
+
+	return avx2 != 0;
+}
+#endif
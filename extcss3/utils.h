@@ -5,17 +5,43 @@
 
 /* ==================================================================================================== */
 
+/* GCC and Clang on x86 can select the AVX2 code paths at runtime, see extcss3_cpu_has_avx2() */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define EXTCSS3_HAVE_AVX2
+#endif
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* The character classes of extcss3_char_class[] */
+#define EXTCSS3_CC_WS				((uint8_t)0x01)
+#define EXTCSS3_CC_DIGIT			((uint8_t)0x02)
+#define EXTCSS3_CC_HEX				((uint8_t)0x04)
+#define EXTCSS3_CC_LETTER			((uint8_t)0x08)
+#define EXTCSS3_CC_NAME_START		((uint8_t)0x10)
+#define EXTCSS3_CC_NAME				((uint8_t)0x20)
+#define EXTCSS3_CC_NON_PRINTABLE	((uint8_t)0x40)
+
+#define EXTCSS3_CHAR_IS(c, cc)		((extcss3_char_class[(unsigned char)(c)] & (cc)) != 0)
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
 /* https://www.w3.org/TR/css-syntax-3/#whitespace */
-#define EXTCSS3_IS_WS(c)			(((c) == ' ') || ((c) == '\n') || ((c) == '\t'))
+#define EXTCSS3_IS_WS(c)			EXTCSS3_CHAR_IS(c, EXTCSS3_CC_WS)
 
 /* https://www.w3.org/TR/css-syntax-3/#digit */
-#define EXTCSS3_IS_DIGIT(c)			(((c) >= '0') && ((c) <= '9'))
+#define EXTCSS3_IS_DIGIT(c)			EXTCSS3_CHAR_IS(c, EXTCSS3_CC_DIGIT)
 
 /* https://www.w3.org/TR/css-syntax-3/#letter */
-#define EXTCSS3_IS_LETTER(c)		((((c) >= 'a') && ((c) <= 'z')) || (((c) >= 'A') && ((c) <= 'Z')))
+#define EXTCSS3_IS_LETTER(c)		EXTCSS3_CHAR_IS(c, EXTCSS3_CC_LETTER)
+
+/* https://www.w3.org/TR/css-syntax-3/#name-start-code-point */
+#define EXTCSS3_IS_NAME_START(c)	EXTCSS3_CHAR_IS(c, EXTCSS3_CC_NAME_START)
+
+/* https://www.w3.org/TR/css-syntax-3/#name-code-point */
+#define EXTCSS3_IS_NAME(c)			EXTCSS3_CHAR_IS(c, EXTCSS3_CC_NAME)
 
 /* https://www.w3.org/TR/css-syntax-3/#non-printable-code-point */
-#define EXTCSS3_NON_PRINTABLE(c)	((((c) >= 0x00) && ((c) <= 0x08)) || ((c) == 0x0B) || (((c) >= 0x0E) && ((c) <= 0x1F)) || ((c) == 0x7F))
+#define EXTCSS3_NON_PRINTABLE(c)	EXTCSS3_CHAR_IS(c, EXTCSS3_CC_NON_PRINTABLE)
 
 /* https://www.w3.org/TR/css-syntax-3/#maximum-allowed-code-point (U+10FFFF) */
 #define EXTCSS3_MAX_ALLOWED_CP		((int)1114111)
@@ -23,7 +49,7 @@
 /* https://www.w3.org/TR/css-syntax-3/#surrogate-code-point (U+D800 - U+DFFF) */
 #define EXTCSS3_FOR_SURROGATE_CP(i)	(((i) >= 55296) && ((i) <= 57343))
 
-#define EXTCSS3_IS_HEX(c)			(EXTCSS3_IS_DIGIT(c) || (((c) >= 'a') && ((c) <= 'f')) || (((c) >= 'A') && ((c) <= 'F')))
+#define EXTCSS3_IS_HEX(c)			EXTCSS3_CHAR_IS(c, EXTCSS3_CC_HEX)
 
 #define EXTCSS3_IS_NON_ASCII(c)		((((c) >> 7) & 1) != 0)
 
@@ -50,18 +76,65 @@
 	( ((a) >= 'A') && ((a) <= 'Z') && ((b) >= 'a') && ((b) <= 'z') && (((a) + 32) == (b)) ) \
 )
 
+#define _EXTCSS3_TYPE_HAS_KEYWORD(type)	(				\
+	((type) == EXTCSS3_TYPE_IDENT)		||				\
+	((type) == EXTCSS3_TYPE_FUNCTION)	||				\
+	((type) == EXTCSS3_TYPE_AT_KEYWORD)					\
+)
+
+#define _EXTCSS3_TYPE_IS_NUMERIC(type)	(				\
+	((type) == EXTCSS3_TYPE_NUMBER)		||				\
+	((type) == EXTCSS3_TYPE_PERCENTAGE)	||				\
+	((type) == EXTCSS3_TYPE_DIMENSION)					\
+)
+
 #define _EXTCSS3_TYPE_EMPTY(type)		(((type) == EXTCSS3_TYPE_WS) || ((type) == EXTCSS3_TYPE_COMMENT))
 
-#define _EXTCSS3_TYPE_EMPTY_EX(token)	(			\
-	((token)->type == EXTCSS3_TYPE_WS) ||			\
-	(												\
-		((token)->type == EXTCSS3_TYPE_COMMENT) &&	\
-		((token)->user.str == NULL)					\
-	)												\
+#define _EXTCSS3_TYPE_EMPTY_EX(intern, token)	(						\
+	(EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_WS) ||			\
+	(																	\
+		(EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_COMMENT) &&	\
+		((token)->user_off == 0)										\
+	)																	\
+)
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define EXTCSS3_TOKEN(intern, i)			((i) ? ((intern)->tokens + (i)) : NULL)
+#define EXTCSS3_TOKEN_INDEX(intern, token)	((token) ? (uint32_t)((token) - (intern)->tokens) : 0)
+
+#define EXTCSS3_TOKEN_TYPE(intern, token)	((intern)->types[(token) - (intern)->tokens])
+
+/* The keyword ID of the token, 0 for none, see extcss3_get_keyword() */
+#define EXTCSS3_TOKEN_KEYWORD(intern, token) (											\
+	_EXTCSS3_TYPE_HAS_KEYWORD(EXTCSS3_TOKEN_TYPE(intern, token))						\
+		? (uint8_t)(token)->id															\
+		: (uint8_t)0																	\
+)
+
+/* The parsed value of a number, percentage or dimension token, NULL for none, see extcss3_create_number() */
+#define EXTCSS3_TOKEN_NUMBER(intern, token) (											\
+	(_EXTCSS3_TYPE_IS_NUMERIC(EXTCSS3_TOKEN_TYPE(intern, token)) && (token)->id)		\
+		? ((intern)->numbers + (token)->id)												\
+		: NULL																			\
+)
+
+#define EXTCSS3_TOKEN_PREV(intern, token)	EXTCSS3_TOKEN(intern, (token)->prev)
+#define EXTCSS3_TOKEN_NEXT(intern, token)	EXTCSS3_TOKEN(intern, (token)->next)
+
+#define EXTCSS3_TOKEN_DATA(intern, token)	((intern)->copy.str + (token)->data_off)
+#define EXTCSS3_TOKEN_USER(intern, token)	((intern)->strings + (token)->user_off)
+
+#define EXTCSS3_TOKEN_INFO(intern, token) (														\
+	(((token)->flag == EXTCSS3_FLAG_STRING) || ((token)->flag == EXTCSS3_FLAG_AT_URL_STRING))	\
+		? EXTCSS3_TOKEN_DATA(intern, token)														\
+		: (EXTCSS3_TOKEN_DATA(intern, token) + (token)->data_len - (token)->info_len)			\
 )
 
 /* ==================================================================================================== */
 
+extern const uint8_t extcss3_char_class[256];
+
 unsigned int extcss3_char_len(char c);
 
 bool extcss3_ascii_strncasecmp(const char *str1, const char *str2, unsigned char n);
@@ -69,6 +142,10 @@ bool extcss3_ascii_strncasecmp(const char *str1, const char *str2, unsigned char
 char *extcss3_get_type_str(unsigned int type);
 char *extcss3_get_flag_str(unsigned int flag);
 
+#if defined(EXTCSS3_HAVE_AVX2)
+bool extcss3_cpu_has_avx2(void);
+#endif
+
 /* ==================================================================================================== */
 
 #endif /* EXTCSS3_UTILS_H */
@@ -4,6 +4,7 @@
 #include "extcss3/utils.h"
 #include "extcss3/dumper/dumper.h"
 #include "extcss3/minifier/minifier.h"
+#include "extcss3/tokenizer/tokenizer.h"
 
 #include <Zend/zend_exceptions.h>
 #include <ext/standard/info.h>
@@ -70,6 +71,7 @@ static inline void php_extcss3_throw_exception(unsigned int error)
 static inline void php_extcss3_make_data_array(extcss3_intern *intern, zval *data)
 {
 	extcss3_ctxt *ctxt = intern->last_ctxt;
+	extcss3_token *token;
 	zval empty, info, context, contexts, value;
 
 	array_init(&empty);
@@ -78,17 +80,17 @@ static inline void php_extcss3_make_data_array(extcss3_intern *intern, zval *dat
 
 	ZVAL_ARR(data, zend_array_dup(Z_ARRVAL(empty)));
 
-	ZVAL_LONG(&value, intern->last_token->type);
+	ZVAL_LONG(&value, EXTCSS3_TOKEN_TYPE(intern, intern->last_token));
 	zend_hash_str_update(Z_ARRVAL_P(data), "type", 4 /*strlen("type")*/, &value);
 
-	ZVAL_STRING(&value, extcss3_get_type_str(intern->last_token->type));
+	ZVAL_STRING(&value, extcss3_get_type_str(EXTCSS3_TOKEN_TYPE(intern, intern->last_token)));
 	zend_hash_str_update(Z_ARRVAL_P(data), "name", 4 /*strlen("name")*/, &value);
 
-	ZVAL_STRINGL(&value, intern->last_token->data.str, intern->last_token->data.len);
+	ZVAL_STRINGL(&value, EXTCSS3_TOKEN_DATA(intern, intern->last_token), intern->last_token->data_len);
 	zend_hash_str_update(Z_ARRVAL_P(data), "value", 5 /*strlen("value")*/, &value);
 
-	if (intern->last_token->user.str) {
-		ZVAL_STRINGL(&value, intern->last_token->user.str, intern->last_token->user.len);
+	if (intern->last_token->user_off) {
+		ZVAL_STRINGL(&value, EXTCSS3_TOKEN_USER(intern, intern->last_token), intern->last_token->user_len);
 		zend_hash_str_update(Z_ARRVAL_P(data), "user", 4 /*strlen("user")*/, &value);
 	}
 
@@ -101,8 +103,8 @@ static inline void php_extcss3_make_data_array(extcss3_intern *intern, zval *dat
 		ZVAL_STRING(&value, extcss3_get_flag_str(intern->last_token->flag));
 		zend_hash_str_update(Z_ARRVAL(info), "name", 4 /*strlen("name")*/, &value);
 
-		if (intern->last_token->info.len) {
-			ZVAL_STRINGL(&value, intern->last_token->info.str, intern->last_token->info.len);
+		if (intern->last_token->info_len) {
+			ZVAL_STRINGL(&value, EXTCSS3_TOKEN_INFO(intern, intern->last_token), intern->last_token->info_len);
 			zend_hash_str_update(Z_ARRVAL(info), "value", 5 /*strlen("value")*/, &value);
 		}
 
@@ -115,21 +117,23 @@ static inline void php_extcss3_make_data_array(extcss3_intern *intern, zval *dat
 		while (ctxt->level) {
 			ZVAL_ARR(&context, zend_array_dup(Z_ARRVAL(empty)));
 
+			token = EXTCSS3_TOKEN(intern, ctxt->token);
+
 			ZVAL_LONG(&value, ctxt->level);
 			zend_hash_str_update(Z_ARRVAL(context), "level", 5 /*strlen("level")*/, &value);
 
-			ZVAL_LONG(&value, ctxt->token->type);
+			ZVAL_LONG(&value, EXTCSS3_TOKEN_TYPE(intern, token));
 			zend_hash_str_update(Z_ARRVAL(context), "type", 4 /*strlen("type")*/, &value);
 
-			ZVAL_STRING(&value, extcss3_get_type_str(ctxt->token->type));
+			ZVAL_STRING(&value, extcss3_get_type_str(EXTCSS3_TOKEN_TYPE(intern, token)));
 			zend_hash_str_update(Z_ARRVAL(context), "name", 4 /*strlen("name")*/, &value);
 
-			ZVAL_STRINGL(&value, ctxt->token->data.str, ctxt->token->data.len);
+			ZVAL_STRINGL(&value, EXTCSS3_TOKEN_DATA(intern, token), token->data_len);
 			zend_hash_str_update(Z_ARRVAL(context), "value", 5 /*strlen("value")*/, &value);
 
 			zend_hash_next_index_insert(Z_ARRVAL(contexts), &context);
 
-			ctxt = ctxt->prev;
+			ctxt--;
 		}
 
 		zend_hash_str_update(Z_ARRVAL_P(data), "context", 7 /*strlen("context")*/, &contexts);
@@ -141,12 +145,13 @@ static inline void php_extcss3_make_data_array(extcss3_intern *intern, zval *dat
 static void php_extcss3_modifier_callback(extcss3_intern *intern)
 {
 	zval data, retval, *args, *callable = NULL;
+	char *user;
 
 	if ((intern == NULL) || (intern->last_token == NULL)) {
 		return;
 	}
 
-	switch (intern->last_token->type) {
+	switch (EXTCSS3_TOKEN_TYPE(intern, intern->last_token)) {
 		case EXTCSS3_TYPE_STRING:
 			callable = intern->modifier.string;
 			break;
@@ -177,10 +182,9 @@ static void php_extcss3_modifier_callback(extcss3_intern *intern)
 
 	if (SUCCESS == call_user_function_ex(EG(function_table), NULL, callable, &retval, 1, args, 0, NULL)) {
 		if (Z_TYPE(retval) == IS_STRING) {
-			intern->last_token->user.len = Z_STRLEN(retval);
-			intern->last_token->user.str = (char *)calloc(intern->last_token->user.len, sizeof(char));
-
-			memcpy(intern->last_token->user.str, Z_STRVAL(retval), Z_STRLEN(retval));
+			if ((user = extcss3_create_user_str(intern, intern->last_token, Z_STRLEN(retval))) != NULL) {
+				memcpy(user, Z_STRVAL(retval), Z_STRLEN(retval));
+			}
 		}
 	}
 
@@ -191,6 +195,87 @@ static void php_extcss3_modifier_callback(extcss3_intern *intern)
 	efree(args);
 }
 
+static inline bool php_extcss3_vendors_unchanged(extcss3_intern *intern, zval *vendors)
+{
+	extcss3_vendor *vendor = intern->base_vendor;
+	zval *name;
+
+	if ((vendors == NULL) || (Z_TYPE_P(vendors) != IS_ARRAY)) {
+		return vendor == NULL;
+	}
+
+	ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(vendors), name) {
+		if (
+			(vendor == NULL) ||
+			(Z_TYPE_P(name) != IS_STRING) ||
+			(vendor->name.len != Z_STRLEN_P(name)) ||
+			(memcmp(vendor->name.str, Z_STRVAL_P(name), vendor->name.len) != 0)
+		) {
+			return false;
+		}
+
+		vendor = vendor->next;
+	} ZEND_HASH_FOREACH_END();
+
+	return vendor == NULL;
+}
+
+static void *php_extcss3_malloc(void *data, size_t size)
+{
+	(void)data;
+
+	return emalloc(size);
+}
+
+static void *php_extcss3_realloc(void *data, void *ptr, size_t size)
+{
+	(void)data;
+
+	return erealloc(ptr, size);
+}
+
+static void php_extcss3_free(void *data, void *ptr)
+{
+	(void)data;
+
+	efree(ptr);
+}
+
+/* All buffers of the intern are taken from the Zend memory manager */
+static const extcss3_allocator php_extcss3_allocator = {
+	php_extcss3_malloc,
+	php_extcss3_realloc,
+	php_extcss3_free,
+	NULL
+};
+
+static char *php_extcss3_output_alloc(extcss3_intern *intern, size_t size)
+{
+	zend_string *str = zend_string_alloc(size - 1, 0);
+
+	intern->output.buffer = str;
+
+	return ZSTR_VAL(str);
+}
+
+static inline zend_string *php_extcss3_output_fetch(extcss3_intern *intern)
+{
+	zend_string *str = (zend_string *)intern->output.buffer;
+
+	intern->output.buffer = NULL;
+
+	// The result was written straight into the string, only give back the unused rest
+	return zend_string_truncate(str, intern->output.len, 0);
+}
+
+static inline void php_extcss3_output_release(extcss3_intern *intern)
+{
+	if (intern->output.buffer != NULL) {
+		zend_string_release((zend_string *)intern->output.buffer);
+		intern->output.buffer = NULL;
+	}
+}
+
 static void php_extcss3_modifier_destructor(void *modifier)
 {
 	zval *ptr = (zval *)modifier;
@@ -213,10 +298,18 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_EXTCSS3_setModifier, 0, 0, 2)
 	ZEND_ARG_TYPE_INFO(0, callable, IS_CALLABLE, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_EXTCSS3_setHighWaterMark, 0, 0, 1)
+	ZEND_ARG_TYPE_INFO(0, bytes, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_EXTCSS3_dump, 0, 0, 1)
 	ZEND_ARG_TYPE_INFO(0, css, IS_STRING, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_EXTCSS3_tokenize, 0, 0, 1)
+	ZEND_ARG_TYPE_INFO(0, css, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_EXTCSS3_minify, 0, 0, 1)
 	ZEND_ARG_TYPE_INFO(0, css, IS_STRING, 0)
 	ZEND_ARG_TYPE_INFO(0, vendors, IS_ARRAY, 1)
@@ -227,13 +320,14 @@ ZEND_END_ARG_INFO()
 PHP_METHOD(CSS3Processor, __construct)
 {
 	extcss3_object *object = extcss3_object_fetch(Z_OBJ_P(getThis()));
-	extcss3_intern *intern = extcss3_create_intern();
+	extcss3_intern *intern = extcss3_create_intern(&php_extcss3_allocator);
 
 	if (intern == NULL) {
 		php_extcss3_throw_exception(EXTCSS3_ERR_MEMORY);
 	} else {
 		intern->modifier.callback	= php_extcss3_modifier_callback;
 		intern->modifier.destructor	= php_extcss3_modifier_destructor;
+		intern->output.alloc		= php_extcss3_output_alloc;
 
 		object->intern = intern;
 	}
@@ -276,11 +370,34 @@ PHP_METHOD(CSS3Processor, setModifier)
 	RETURN_TRUE;
 }
 
+PHP_METHOD(CSS3Processor, setHighWaterMark)
+{
+	extcss3_object *object = extcss3_object_fetch(Z_OBJ_P(getThis()));
+	extcss3_intern *intern = object->intern;
+	zend_long bytes;
+	unsigned int error = 0;
+
+	if (SUCCESS != zend_parse_parameters(ZEND_NUM_ARGS(), "l", &bytes)) {
+		return;
+	} else if (intern == NULL) {
+		php_extcss3_throw_exception(EXTCSS3_ERR_NULL_PTR);
+		return;
+	} else if (bytes < 0) {
+		php_extcss3_throw_exception(EXTCSS3_ERR_INV_PARAM);
+		return;
+	} else if (EXTCSS3_SUCCESS != extcss3_set_high_water_mark(intern, (size_t)bytes, &error)) {
+		php_extcss3_throw_exception(error);
+		return;
+	}
+
+	RETURN_TRUE;
+}
+
 PHP_METHOD(CSS3Processor, dump)
 {
 	extcss3_object *object = extcss3_object_fetch(Z_OBJ_P(getThis()));
 	extcss3_intern *intern = object->intern;
-	char *css, *result;
+	char *css;
 	size_t len;
 	unsigned int error = 0;
 
@@ -292,12 +409,90 @@ PHP_METHOD(CSS3Processor, dump)
 		RETURN_EMPTY_STRING();
 	} else if (EXTCSS3_SUCCESS != extcss3_set_css_string(intern, css, len, &error)) {
 		php_extcss3_throw_exception(error);
-	} else if ((result = extcss3_dump_tokens(intern, &error)) == NULL) {
+	} else if (extcss3_dump_tokens(intern, &error) == NULL) {
+		php_extcss3_output_release(intern);
 		php_extcss3_throw_exception(error);
 	} else {
-		RETVAL_STRING(result);
-		free(result);
+		RETVAL_NEW_STR(php_extcss3_output_fetch(intern));
 	}
+
+	// Keep the buffers of the intern warm for the next call
+	extcss3_reset_intern(intern);
+}
+
+PHP_METHOD(CSS3Processor, tokenize)
+{
+	extcss3_object *object = extcss3_object_fetch(Z_OBJ_P(getThis()));
+	extcss3_intern *intern = object->intern;
+	extcss3_token *token;
+	extcss3_mod modifier;
+	zval types, offsets, lengths, flags, value;
+	char *css;
+	size_t len;
+	unsigned int error = 0;
+
+	if (SUCCESS != zend_parse_parameters(ZEND_NUM_ARGS(), "s", &css, &len)) {
+		return;
+	} else if (intern == NULL) {
+		php_extcss3_throw_exception(EXTCSS3_ERR_NULL_PTR);
+		return;
+	}
+
+	array_init(&types);
+	array_init(&offsets);
+	array_init(&lengths);
+	array_init(&flags);
+
+	if (len) {
+		// The registered modifiers are not called, which also allows the "stream" mode of the tokenizer
+		modifier = intern->modifier;
+		intern->modifier.string = intern->modifier.bad_string = NULL;
+		intern->modifier.url = intern->modifier.bad_url = intern->modifier.comment = NULL;
+
+		if (
+			(EXTCSS3_SUCCESS != extcss3_set_css_string(intern, css, len, &error)) ||
+			(EXTCSS3_SUCCESS != extcss3_tokenizer_start(intern, true, &error))
+		) {
+			token = NULL;
+		} else {
+			while (((token = extcss3_next_token(intern, &error)) != NULL) && (EXTCSS3_TOKEN_TYPE(intern, token) != EXTCSS3_TYPE_EOF)) {
+				add_next_index_long(&types, EXTCSS3_TOKEN_TYPE(intern, token));
+				add_next_index_long(&offsets, token->data_off);
+				add_next_index_long(&lengths, token->data_len);
+				add_next_index_long(&flags, token->flag);
+			}
+		}
+
+		intern->modifier = modifier;
+
+		if (token == NULL) {
+			zval_ptr_dtor(&types);
+			zval_ptr_dtor(&offsets);
+			zval_ptr_dtor(&lengths);
+			zval_ptr_dtor(&flags);
+
+			extcss3_reset_intern(intern);
+
+			php_extcss3_throw_exception(error);
+			return;
+		}
+
+		// The offsets point into the preprocessed string, it ends at the EOF token
+		ZVAL_STRINGL(&value, intern->copy.str, token->data_off);
+	} else {
+		ZVAL_EMPTY_STRING(&value);
+	}
+
+	array_init(return_value);
+
+	zend_hash_str_update(Z_ARRVAL_P(return_value), "css", 3 /*strlen("css")*/, &value);
+	zend_hash_str_update(Z_ARRVAL_P(return_value), "type", 4 /*strlen("type")*/, &types);
+	zend_hash_str_update(Z_ARRVAL_P(return_value), "offset", 6 /*strlen("offset")*/, &offsets);
+	zend_hash_str_update(Z_ARRVAL_P(return_value), "length", 6 /*strlen("length")*/, &lengths);
+	zend_hash_str_update(Z_ARRVAL_P(return_value), "flag", 4 /*strlen("flag")*/, &flags);
+
+	// Keep the buffers of the intern warm for the next call
+	extcss3_reset_intern(intern);
 }
 
 PHP_METHOD(CSS3Processor, minify)
@@ -305,7 +500,7 @@ PHP_METHOD(CSS3Processor, minify)
 	extcss3_object *object = extcss3_object_fetch(Z_OBJ_P(getThis()));
 	extcss3_intern *intern = object->intern;
 	zval *name, *vendors = NULL;
-	char *css, *result;
+	char *css;
 	size_t len;
 	unsigned int error = 0;
 
@@ -321,8 +516,11 @@ PHP_METHOD(CSS3Processor, minify)
 		return;
 	}
 
-	if ((intern->base_vendor != NULL) || (intern->last_vendor != NULL)) {
-		extcss3_release_vendors_list(intern->base_vendor);
+	// The vendors list of the previous call is kept as long as it is the same
+	if (php_extcss3_vendors_unchanged(intern, vendors)) {
+		vendors = NULL;
+	} else if ((intern->base_vendor != NULL) || (intern->last_vendor != NULL)) {
+		extcss3_release_vendors_list(intern, intern->base_vendor);
 		intern->base_vendor = intern->last_vendor = NULL;
 	}
 
@@ -333,25 +531,36 @@ PHP_METHOD(CSS3Processor, minify)
 			}
 
 			if (intern->last_vendor == NULL) {
-				intern->base_vendor = intern->last_vendor = extcss3_create_vendor();
+				intern->base_vendor = intern->last_vendor = extcss3_create_vendor(intern);
 			} else {
-				intern->last_vendor->next = extcss3_create_vendor();
+				intern->last_vendor->next = extcss3_create_vendor(intern);
 				intern->last_vendor = intern->last_vendor->next;
 			}
 
-			if ((intern->last_vendor == NULL) || (EXTCSS3_SUCCESS != extcss3_set_vendor_string(intern, Z_STRVAL_P(name), Z_STRLEN_P(name), &error))) {
-				php_extcss3_throw_exception(error);
-				return;
+			if (intern->last_vendor == NULL) {
+				error = EXTCSS3_ERR_MEMORY;
+				break;
+			} else if (EXTCSS3_SUCCESS != extcss3_set_vendor_string(intern, Z_STRVAL_P(name), Z_STRLEN_P(name), &error)) {
+				break;
 			}
 		} ZEND_HASH_FOREACH_END();
 	}
 
-	if ((result = extcss3_minify(intern, &error)) == NULL) {
+	if (error) {
+		// A partial vendors list must not be taken as unchanged by the next call
+		extcss3_release_vendors_list(intern, intern->base_vendor);
+		intern->base_vendor = intern->last_vendor = NULL;
+
+		php_extcss3_throw_exception(error);
+	} else if (extcss3_minify(intern, &error) == NULL) {
+		php_extcss3_output_release(intern);
 		php_extcss3_throw_exception(error);
 	} else {
-		RETVAL_STRING(result);
-		free(result);
+		RETVAL_NEW_STR(php_extcss3_output_fetch(intern));
 	}
+
+	// Keep the buffers of the intern warm for the next call
+	extcss3_reset_intern(intern);
 }
 
 /* ==================================================================================================== */
@@ -359,7 +568,9 @@ PHP_METHOD(CSS3Processor, minify)
 zend_function_entry extcss3_methods[] = {
 	PHP_ME(CSS3Processor, __construct, arginfo_EXTCSS3_void, ZEND_ACC_PUBLIC | ZEND_ACC_CTOR)
 	PHP_ME(CSS3Processor, setModifier, arginfo_EXTCSS3_setModifier, ZEND_ACC_PUBLIC)
+	PHP_ME(CSS3Processor, setHighWaterMark, arginfo_EXTCSS3_setHighWaterMark, ZEND_ACC_PUBLIC)
 	PHP_ME(CSS3Processor, dump, arginfo_EXTCSS3_dump, ZEND_ACC_PUBLIC)
+	PHP_ME(CSS3Processor, tokenize, arginfo_EXTCSS3_tokenize, ZEND_ACC_PUBLIC)
 	PHP_ME(CSS3Processor, minify, arginfo_EXTCSS3_minify, ZEND_ACC_PUBLIC)
 	PHP_FE_END
 };
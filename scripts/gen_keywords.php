@@ -0,0 +1,105 @@
+<?php
+
+/**
+ * Generates the perfect hash of the keywords in extcss3/keywords.c
+ *
+ * Usage: php scripts/gen_keywords.php [path/to/keywords.c]
+ *
+ * The keywords are read from the extcss3_keywords[] list of the file and the number of slots from
+ * _EXTCSS3_KEYWORD_SLOTS. The first seed (counting from 0) that puts every keyword into a slot of its own is
+ * searched, then _EXTCSS3_KEYWORD_SEED and the table _extcss3_keyword_slots[] are rewritten in place. The hash
+ * has to match _extcss3_keyword_hash().
+ */
+
+const MAX_SEED = 0xFFFFFFFF;
+
+$sFile = isset($argv[1]) ? $argv[1] : __DIR__ . '/../extcss3/keywords.c';
+
+if (PHP_INT_SIZE < 8) {
+	fwrite(STDERR, "A 64-bit build of PHP is required\n");
+	exit(1);
+}
+
+if (($sSource = file_get_contents($sFile)) === false) {
+	fwrite(STDERR, "Unable to read {$sFile}\n");
+	exit(1);
+}
+
+if (!preg_match('/extcss3_keywords\[EXTCSS3_KEYWORDS\] = \{(.*?)\};/s', $sSource, $aMatch)) {
+	fwrite(STDERR, "No extcss3_keywords[] list in {$sFile}\n");
+	exit(1);
+}
+
+preg_match_all('/"([^"]*)"/', $aMatch[1], $aMatches);
+
+if (!preg_match('/#define _EXTCSS3_KEYWORD_SLOTS\s+\(\(size_t\)(\d+)\)/', $sSource, $aDefine)) {
+	fwrite(STDERR, "No _EXTCSS3_KEYWORD_SLOTS in {$sFile}\n");
+	exit(1);
+}
+
+// A power of two, the hash is masked
+define('SLOTS', (int)$aDefine[1]);
+
+// ID 0 is EXTCSS3_KEYWORD_NONE
+$aKeywords = array_slice($aMatches[1], 1);
+
+/* ==================================================================================================== */
+
+/**
+ * FNV-1a hash of the ASCII case folded bytes, see _extcss3_keyword_hash()
+ */
+function keywordHash($sKeyword, $iSeed)
+{
+	$iHash = $iSeed;
+
+	for ($i = 0, $iLen = strlen($sKeyword); $i < $iLen; $i++) {
+		$iHash = (($iHash ^ (ord($sKeyword[$i]) | 0x20)) * 0x01000193) & 0xFFFFFFFF;
+	}
+
+	return ($iHash >> 16) & (SLOTS - 1);
+}
+
+/* ==================================================================================================== */
+
+for ($iSeed = 0; $iSeed <= MAX_SEED; $iSeed++) {
+	$aSlots = array_fill(0, SLOTS, 0);
+
+	foreach ($aKeywords as $i => $sKeyword) {
+		$iSlot = keywordHash($sKeyword, $iSeed);
+
+		if ($aSlots[$iSlot] !== 0) {
+			continue 2;
+		}
+
+		$aSlots[$iSlot] = $i + 1;
+	}
+
+	break;
+}
+
+if ($iSeed > MAX_SEED) {
+	fwrite(STDERR, "No seed found, increase the number of slots\n");
+	exit(1);
+}
+
+$aRows = [];
+
+foreach (array_chunk($aSlots, 16) as $aRow) {
+	$aRows[] = "\t" . implode(', ', array_map(function ($iID) { return sprintf('%3d', $iID); }, $aRow));
+}
+
+$sSource = preg_replace(
+	'/(#define _EXTCSS3_KEYWORD_SEED\s+\(\(uint32_t\))0x[0-9A-F]+\)/',
+	sprintf('${1}0x%X)', $iSeed),
+	$sSource
+);
+
+$sSource = preg_replace(
+	'/(_extcss3_keyword_slots\[_EXTCSS3_KEYWORD_SLOTS\] = \{\n).*?(\n\};)/s',
+	'${1}' . implode(",\n", $aRows) . '${2}',
+	$sSource
+);
+
+file_put_contents($sFile, $sSource);
+
+printf("%d keywords, seed 0x%X\n", count($aKeywords), $iSeed);
@@ -0,0 +1,268 @@
+/**
+ * Test of the chunked input of the tokenizer, see extcss3_push_css_chunk()
+ *
+ * The chunked input is not reachable from PHP, so this test is a C program that is built and run by "make test".
+ * Every css string is pushed in chunks of 1 to TEST_CHUNK_MAX bytes (and a few larger ones) and the tokens of both
+ * tokenizer modes have to match the tokens of the whole string, or the same error has to be reported.
+ */
+
+#include "intern.h"
+#include "utils.h"
+#include "tokenizer/tokenizer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ==================================================================================================== */
+
+/* All chunk sizes up to this one are tested, it is beyond the lookahead of the tokenizer */
+#define TEST_CHUNK_MAX		80
+
+/* Larger chunk sizes, around the size of the copy-string buffers and beyond the length of the long css string */
+static const size_t test_chunk_sizes[] = { 100, 127, 128, 1000, 4096, 65536, 262144 };
+
+#define TEST_CHUNK_SIZES	(sizeof(test_chunk_sizes) / sizeof(test_chunk_sizes[0]))
+
+/* Number of repetitions of the long css string, see _test_long_css() */
+#define TEST_LONG_REPEAT	((size_t)2000)
+
+/* Maximum length of the copy-string in the "stream" mode of the long css string, in addition to the chunk size */
+#define TEST_LONG_BUFFER	((size_t)4096)
+
+typedef struct _test_case
+{
+	const char	*name;
+	const char	*css;
+	size_t		len;
+} test_case;
+
+#define TEST_CASE(name, css) { name, css, sizeof(css) - 1 }
+
+static const test_case test_cases[] = {
+	TEST_CASE("strings",			"a{content:\"a long string\";b:'single \\' quoted'}c{d:\"unclosed\ne:'x"),
+	TEST_CASE("comments",			"/* a comment */a{/**/b:c/* * / ** */}/* unclosed *"),
+	TEST_CASE("urls",				"a{b:url( x.png );c:url(\"y.png\");d:url(bad\"url) e;f:url(data:image/png;base64,QUJDQUJD)}"),
+	TEST_CASE("escapes",			".a\\31 23\\,x{content:\"\\26 \\\"\\\n\";b:url(\\29 x)}#\\000041{}"),
+	TEST_CASE("replaced escapes",	"a\\0 b{c:\"\\D800 \\110000\\000000\";d:url(\\0)}\\0"),
+	TEST_CASE("newlines",			"a{\r\nb:c;\r\n\rd:\"e\\\r\nf\";\f}\r\n\r"),
+	TEST_CASE("nul bytes",			"a\0b{c:\"\0\";d:url(\0)}\0"),
+	TEST_CASE("utf-8",				".\xC3\xA9l\xC3\xA9ment{content:\"\xE6\x97\xA5\xE6\x9C\xAC \xF0\x9F\x98\x80\";b:\xE2\x82\xAC}"),
+	TEST_CASE("numbers",			"a{b:-1.5e+3px;c:+.5%;d:1e;e:U+00?\?-FF;f:#fff}"),
+	TEST_CASE("at-rules",			"@import \"a.css\";@import /* x */ 'b.css' screen;@media screen{a{b:c}}<!-- -->"),
+	TEST_CASE("corrupt tail",		"a{b:c}\xE2\x82"),
+	TEST_CASE("corrupt byte",		"a{b:\"\xC3\xA9\x80\"}"),
+	TEST_CASE("empty",				""),
+};
+
+/* ==================================================================================================== */
+
+/**
+ * Append a line for the token to the "out" string
+ */
+static void _test_print_token(FILE *out, extcss3_intern *intern, extcss3_token *token)
+{
+	fprintf(out, "%u %u %.*s", EXTCSS3_TOKEN_TYPE(intern, token), token->flag, (int)token->data_len, EXTCSS3_TOKEN_DATA(intern, token));
+
+	if (token->info_len) {
+		fprintf(out, " (%.*s)", (int)token->info_len, EXTCSS3_TOKEN_INFO(intern, token));
+	}
+
+	fputc('\n', out);
+}
+
+/**
+ * Print the tokens of the whole css string
+ */
+static void _test_tokenize(FILE *out, extcss3_intern *intern, const char *css, size_t len)
+{
+	extcss3_token *token;
+	unsigned int error = 0;
+	char *copy;
+
+	// extcss3_set_css_string() may tokenize the string in place
+	if ((copy = malloc(len + 1)) == NULL) {
+		fprintf(out, "ERROR %u\n", EXTCSS3_ERR_MEMORY);
+		return;
+	}
+
+	memcpy(copy, css, len);
+	copy[len] = '\0';
+
+	if (
+		(EXTCSS3_SUCCESS != extcss3_set_css_string(intern, copy, len, &error)) ||
+		(EXTCSS3_SUCCESS != extcss3_tokenize(intern, &error))
+	) {
+		fprintf(out, "ERROR %u\n", error);
+	} else {
+		for (token = intern->base_token; token != NULL; token = EXTCSS3_TOKEN_NEXT(intern, token)) {
+			_test_print_token(out, intern, token);
+		}
+	}
+
+	extcss3_reset_intern(intern);
+	free(copy);
+}
+
+/**
+ * Print the tokens of the css string pushed in chunks of "size" bytes, the largest copy-string is stored in "buffer_len"
+ */
+static void _test_tokenize_chunked(FILE *out, extcss3_intern *intern, const char *css, size_t len, size_t size, bool stream, size_t *buffer_len)
+{
+	extcss3_token *token;
+	unsigned int error = 0;
+	size_t pos = 0, chunk;
+
+	*buffer_len = 0;
+
+	if (
+		(EXTCSS3_SUCCESS != extcss3_set_css_chunked(intern, &error)) ||
+		(EXTCSS3_SUCCESS != extcss3_tokenizer_start(intern, stream, &error))
+	) {
+		fprintf(out, "ERROR %u\n", error);
+		extcss3_reset_intern(intern);
+
+		return;
+	}
+
+	while (true) {
+		if ((token = extcss3_next_token(intern, &error)) == NULL) {
+			if (error != 0) {
+				fprintf(out, "ERROR %u\n", error);
+				break;
+			}
+
+			chunk = ((len - pos) < size) ? (len - pos) : size;
+
+			if (EXTCSS3_SUCCESS != extcss3_push_css_chunk(intern, css + pos, chunk, (pos + chunk) == len, &error)) {
+				fprintf(out, "ERROR %u\n", error);
+				break;
+			}
+
+			pos += chunk;
+
+			if ((size_t)(intern->state.writer - intern->copy.str) > *buffer_len) {
+				*buffer_len = intern->state.writer - intern->copy.str;
+			}
+
+			continue;
+		}
+
+		// In the "stream" mode the tokens are gone after the next ones
+		if (stream) {
+			_test_print_token(out, intern, token);
+		}
+
+		if (EXTCSS3_TOKEN_TYPE(intern, token) == EXTCSS3_TYPE_EOF) {
+			break;
+		}
+	}
+
+	if (!stream && (token != NULL)) {
+		for (token = intern->base_token; token != NULL; token = EXTCSS3_TOKEN_NEXT(intern, token)) {
+			_test_print_token(out, intern, token);
+		}
+	}
+
+	extcss3_reset_intern(intern);
+}
+
+/**
+ * Compare the tokens of all chunk sizes with the tokens of the whole css string, returns the number of failures
+ *
+ * If "max_buffer_len" is set, the copy-string of the "stream" mode may not exceed it by more than a chunk
+ */
+static unsigned int _test_css(extcss3_intern *intern, const char *name, const char *css, size_t len, size_t max_buffer_len)
+{
+	char *expected = NULL, *result = NULL;
+	size_t expected_len, result_len, size, buffer_len;
+	unsigned int i, failures = 0;
+	int stream;
+	FILE *out;
+
+	if ((out = open_memstream(&expected, &expected_len)) == NULL) {
+		return 1;
+	}
+
+	_test_tokenize(out, intern, css, len);
+	fclose(out);
+
+	for (i = 0; i < (TEST_CHUNK_MAX + TEST_CHUNK_SIZES); i++) {
+		size = (i < TEST_CHUNK_MAX) ? (i + 1) : test_chunk_sizes[i - TEST_CHUNK_MAX];
+
+		for (stream = 0; stream < 2; stream++) {
+			if ((out = open_memstream(&result, &result_len)) == NULL) {
+				free(expected);
+				return failures + 1;
+			}
+
+			_test_tokenize_chunked(out, intern, css, len, size, stream, &buffer_len);
+			fclose(out);
+
+			if ((result_len != expected_len) || (memcmp(result, expected, expected_len) != 0)) {
+				printf("FAIL %s: chunks of %zu bytes (%s mode)\n--- expected\n%s--- result\n%s", name, size, stream ? "stream" : "list", expected, result);
+				failures++;
+			} else if (stream && (max_buffer_len > 0) && (buffer_len > (max_buffer_len + size))) {
+				printf("FAIL %s: chunks of %zu bytes need a copy-string of %zu bytes\n", name, size, buffer_len);
+				failures++;
+			}
+
+			free(result);
+			result = NULL;
+		}
+	}
+
+	free(expected);
+
+	return failures;
+}
+
+/**
+ * A long css string, the "stream" mode has to drop the consumed bytes in front of its tokens
+ */
+static unsigned int _test_long_css(extcss3_intern *intern)
+{
+	const char *rule = ".a\\31 { b: \"c\\0 d\"; e: url( f.png ) } /* g */\r\n";
+	size_t i, rule_len = strlen(rule), len = rule_len * TEST_LONG_REPEAT;
+	unsigned int failures;
+	char *css;
+
+	if ((css = malloc(len)) == NULL) {
+		return 1;
+	}
+
+	for (i = 0; i < TEST_LONG_REPEAT; i++) {
+		memcpy(css + (i * rule_len), rule, rule_len);
+	}
+
+	failures = _test_css(intern, "long", css, len, TEST_LONG_BUFFER);
+
+	free(css);
+
+	return failures;
+}
+
+/* ==================================================================================================== */
+
+int main(void)
+{
+	extcss3_intern *intern;
+	unsigned int i, failures = 0;
+
+	if ((intern = extcss3_create_intern(NULL)) == NULL) {
+		printf("FAIL: extcss3_create_intern()\n");
+		return 1;
+	}
+
+	for (i = 0; i < (sizeof(test_cases) / sizeof(test_cases[0])); i++) {
+		failures += _test_css(intern, test_cases[i].name, test_cases[i].css, test_cases[i].len, 0);
+	}
+
+	failures += _test_long_css(intern);
+
+	extcss3_release_intern(intern);
+
+	printf("%s: chunked tokenizer\n", failures ? "FAIL" : "PASS");
+
+	return failures ? 1 : 0;
+}
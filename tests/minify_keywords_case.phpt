@@ -0,0 +1,44 @@
+--TEST--
+Test CSS3Processor::minify() method for keywords in mixed case
+--FILE--
+<?php
+
+$oProcessor = new \CSS3Processor();
+
+// The at-rules, rgb() and the color names are ASCII case-insensitive, the "@charset" rule has to be lower case
+$sCSS = '@CHARSET "utf-8";
+@IMPORT "a.css";
+@Import url(b.css) screen;
+@NameSpace svg url(x);
+a {
+	color: AliceBlue;
+	outline-color: aLiCeBlUe;
+	border-color: WHITE;
+	background: RGB(255, 0, 0);
+	background-color: Rgb(1, 2, 3);
+	color: AliceBlue1;
+	color: rgba(1, 2, 3);
+}
+@MEDIA screen {
+	b { color: BLACK }
+}
+@Media print {
+	@IMPORT "c.css";
+}
+';
+
+var_dump($oProcessor->minify($sCSS));
+
+$sCSS = '@charset "utf-8";
+@IMPORT "a.css";
+a { color: Black }
+';
+
+var_dump($oProcessor->minify($sCSS));
+
+?>
+===DONE===
+--EXPECT--
+string(222) "@IMPORT"a.css";@Import url(b.css) screen;@NameSpace svg url(x);a{color:#f0f8ff;outline-color:#f0f8ff;border-color:#fff;background:red;background-color:#010203;color:AliceBlue1;color:rgba(1,2,3)}@MEDIA screen{b{color:#000}}"
+string(45) "@charset "utf-8";@IMPORT"a.css";a{color:#000}"
+===DONE===
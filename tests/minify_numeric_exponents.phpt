@@ -0,0 +1,28 @@
+--TEST--
+Test CSS3Processor::minify() method for numeric tokens with exponents
+--FILE--
+<?php
+
+$oProcessor = new \CSS3Processor();
+
+$sCSS = '
+a {
+	a: 1.5e-3;
+	b: 1E+3px;
+	c: 2e1%;
+	d: 12.50e-1em;
+	e: 1000px;
+	f: .00001;
+	g: 1e3e5;
+	h: -0.0e-2;
+	i: rgb(1e2, 2.55e2, 0);
+}
+';
+
+var_dump($oProcessor->minify($sCSS));
+
+?>
+===DONE===
+--EXPECT--
+string(73) "a{a:.0015;b:1e3px;c:20%;d:1.25em;e:1000px;f:.00001;g:1e3e5;h:0;i:#64ff00}"
+===DONE===
@@ -399,17 +399,17 @@ array(8) {
   [0]=>
   string(0) ""
   [1]=>
-  string(390) "a01:0s;b01:0s;c01:0s;a02:1.1E3s;b02:-1.1E3s;c02:1.1E3s;a03:0s;b03:0s;c03:0s;a04:0s;b04:0s;c04:0s;a05:0s;b05:0s;c05:0s;a06:5s;b06:-5s;c06:5s;a07:5s;b07:-5s;c07:5s;a07:5.001s;b07:-5.001s;c07:5.001s;a08:12345s;b08:-12345s;c08:12345s;a09:123.45s;b09:-123.45s;c09:123.45s;a10:0s;b10:0s;c10:0s;a11:.1s;b11:-.1s;c11:.1s;a12:500s;b12:-500s;c12:500s;a13:.1s;b13:-.1s;c13:.1s;a14:10s;b14:-10s;c14:10s"
+  string(387) "a01:0s;b01:0s;c01:0s;a02:1100s;b02:-1100s;c02:1100s;a03:0s;b03:0s;c03:0s;a04:0s;b04:0s;c04:0s;a05:0s;b05:0s;c05:0s;a06:5s;b06:-5s;c06:5s;a07:5s;b07:-5s;c07:5s;a07:5.001s;b07:-5.001s;c07:5.001s;a08:12345s;b08:-12345s;c08:12345s;a09:123.45s;b09:-123.45s;c09:123.45s;a10:0s;b10:0s;c10:0s;a11:.1s;b11:-.1s;c11:.1s;a12:500s;b12:-500s;c12:500s;a13:.1s;b13:-.1s;c13:.1s;a14:10s;b14:-10s;c14:10s"
   [2]=>
-  string(435) "a01:0ms;b01:0ms;c01:0ms;a02:1.1E3ms;b02:-1.1E3ms;c02:1.1E3ms;a03:0ms;b03:0ms;c03:0ms;a04:0ms;b04:0ms;c04:0ms;a05:0ms;b05:0ms;c05:0ms;a06:5ms;b06:-5ms;c06:5ms;a07:5ms;b07:-5ms;c07:5ms;a07:5.001ms;b07:-5.001ms;c07:5.001ms;a08:12345ms;b08:-12345ms;c08:12345ms;a09:123.45ms;b09:-123.45ms;c09:123.45ms;a10:0ms;b10:0ms;c10:0ms;a11:.1ms;b11:-.1ms;c11:.1ms;a12:500ms;b12:-500ms;c12:500ms;a13:.1ms;b13:-.1ms;c13:.1ms;a14:10ms;b14:-10ms;c14:10ms"
+  string(432) "a01:0ms;b01:0ms;c01:0ms;a02:1100ms;b02:-1100ms;c02:1100ms;a03:0ms;b03:0ms;c03:0ms;a04:0ms;b04:0ms;c04:0ms;a05:0ms;b05:0ms;c05:0ms;a06:5ms;b06:-5ms;c06:5ms;a07:5ms;b07:-5ms;c07:5ms;a07:5.001ms;b07:-5.001ms;c07:5.001ms;a08:12345ms;b08:-12345ms;c08:12345ms;a09:123.45ms;b09:-123.45ms;c09:123.45ms;a10:0ms;b10:0ms;c10:0ms;a11:.1ms;b11:-.1ms;c11:.1ms;a12:500ms;b12:-500ms;c12:500ms;a13:.1ms;b13:-.1ms;c13:.1ms;a14:10ms;b14:-10ms;c14:10ms"
   [3]=>
-  string(405) "a01:0;b01:0;c01:0;a02:1.1E3px;b02:-1.1E3px;c02:1.1E3px;a03:0;b03:0;c03:0;a04:0;b04:0;c04:0;a05:0;b05:0;c05:0;a06:5px;b06:-5px;c06:5px;a07:5px;b07:-5px;c07:5px;a07:5.001px;b07:-5.001px;c07:5.001px;a08:12345px;b08:-12345px;c08:12345px;a09:123.45px;b09:-123.45px;c09:123.45px;a10:0;b10:0;c10:0;a11:.1px;b11:-.1px;c11:.1px;a12:500px;b12:-500px;c12:500px;a13:.1px;b13:-.1px;c13:.1px;a14:10px;b14:-10px;c14:10px"
+  string(402) "a01:0;b01:0;c01:0;a02:1100px;b02:-1100px;c02:1100px;a03:0;b03:0;c03:0;a04:0;b04:0;c04:0;a05:0;b05:0;c05:0;a06:5px;b06:-5px;c06:5px;a07:5px;b07:-5px;c07:5px;a07:5.001px;b07:-5.001px;c07:5.001px;a08:12345px;b08:-12345px;c08:12345px;a09:123.45px;b09:-123.45px;c09:123.45px;a10:0;b10:0;c10:0;a11:.1px;b11:-.1px;c11:.1px;a12:500px;b12:-500px;c12:500px;a13:.1px;b13:-.1px;c13:.1px;a14:10px;b14:-10px;c14:10px"
   [4]=>
-  string(375) "a01:0;b01:0;c01:0;a02:1.1E3%;b02:-1.1E3%;c02:1.1E3%;a03:0;b03:0;c03:0;a04:0;b04:0;c04:0;a05:0;b05:0;c05:0;a06:5%;b06:-5%;c06:5%;a07:5%;b07:-5%;c07:5%;a07:5.001%;b07:-5.001%;c07:5.001%;a08:12345%;b08:-12345%;c08:12345%;a09:123.45%;b09:-123.45%;c09:123.45%;a10:0;b10:0;c10:0;a11:.1%;b11:-.1%;c11:.1%;a12:500%;b12:-500%;c12:500%;a13:.1%;b13:-.1%;c13:.1%;a14:10%;b14:-10%;c14:10%"
+  string(372) "a01:0;b01:0;c01:0;a02:1100%;b02:-1100%;c02:1100%;a03:0;b03:0;c03:0;a04:0;b04:0;c04:0;a05:0;b05:0;c05:0;a06:5%;b06:-5%;c06:5%;a07:5%;b07:-5%;c07:5%;a07:5.001%;b07:-5.001%;c07:5.001%;a08:12345%;b08:-12345%;c08:12345%;a09:123.45%;b09:-123.45%;c09:123.45%;a10:0;b10:0;c10:0;a11:.1%;b11:-.1%;c11:.1%;a12:500%;b12:-500%;c12:500%;a13:.1%;b13:-.1%;c13:.1%;a14:10%;b14:-10%;c14:10%"
   [5]=>
-  string(345) "a01:0;b01:0;c01:0;a02:1.1E3;b02:-1.1E3;c02:1.1E3;a03:0;b03:0;c03:0;a04:0;b04:0;c04:0;a05:0;b05:0;c05:0;a06:5;b06:-5;c06:5;a07:5;b07:-5;c07:5;a07:5.001;b07:-5.001;c07:5.001;a08:12345;b08:-12345;c08:12345;a09:123.45;b09:-123.45;c09:123.45;a10:0;b10:0;c10:0;a11:.1;b11:-.1;c11:.1;a12:500;b12:-500;c12:500;a13:.1;b13:-.1;c13:.1;a14:10;b14:-10;c14:10"
+  string(342) "a01:0;b01:0;c01:0;a02:1100;b02:-1100;c02:1100;a03:0;b03:0;c03:0;a04:0;b04:0;c04:0;a05:0;b05:0;c05:0;a06:5;b06:-5;c06:5;a07:5;b07:-5;c07:5;a07:5.001;b07:-5.001;c07:5.001;a08:12345;b08:-12345;c08:12345;a09:123.45;b09:-123.45;c09:123.45;a10:0;b10:0;c10:0;a11:.1;b11:-.1;c11:.1;a12:500;b12:-500;c12:500;a13:.1;b13:-.1;c13:.1;a14:10;b14:-10;c14:10"
   [6]=>
-  string(480) "a01:0xyz;b01:0xyz;c01:0xyz;a02:1.1E3xyz;b02:-1.1E3xyz;c02:1.1E3xyz;a03:0xyz;b03:0xyz;c03:0xyz;a04:0xyz;b04:0xyz;c04:0xyz;a05:0xyz;b05:0xyz;c05:0xyz;a06:5xyz;b06:-5xyz;c06:5xyz;a07:5xyz;b07:-5xyz;c07:5xyz;a07:5.001xyz;b07:-5.001xyz;c07:5.001xyz;a08:12345xyz;b08:-12345xyz;c08:12345xyz;a09:123.45xyz;b09:-123.45xyz;c09:123.45xyz;a10:0xyz;b10:0xyz;c10:0xyz;a11:.1xyz;b11:-.1xyz;c11:.1xyz;a12:500xyz;b12:-500xyz;c12:500xyz;a13:.1xyz;b13:-.1xyz;c13:.1xyz;a14:10xyz;b14:-10xyz;c14:10xyz"
+  string(477) "a01:0xyz;b01:0xyz;c01:0xyz;a02:1100xyz;b02:-1100xyz;c02:1100xyz;a03:0xyz;b03:0xyz;c03:0xyz;a04:0xyz;b04:0xyz;c04:0xyz;a05:0xyz;b05:0xyz;c05:0xyz;a06:5xyz;b06:-5xyz;c06:5xyz;a07:5xyz;b07:-5xyz;c07:5xyz;a07:5.001xyz;b07:-5.001xyz;c07:5.001xyz;a08:12345xyz;b08:-12345xyz;c08:12345xyz;a09:123.45xyz;b09:-123.45xyz;c09:123.45xyz;a10:0xyz;b10:0xyz;c10:0xyz;a11:.1xyz;b11:-.1xyz;c11:.1xyz;a12:500xyz;b12:-500xyz;c12:500xyz;a13:.1xyz;b13:-.1xyz;c13:.1xyz;a14:10xyz;b14:-10xyz;c14:10xyz"
   [7]=>
   string(139) "x:nth-of-type(n+1){a:b}x:nth-of-type(-n-2){a:b}x:nth-of-type(+n+3){a:b}y:nth-child(3n+0){a:b}y:nth-child(3n-0){a:b}y:nth-child(-3n+0){a:b}}"
 }
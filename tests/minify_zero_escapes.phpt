@@ -0,0 +1,18 @@
+--TEST--
+Test the shortened "\0" escapes of CSS3Processor::minify()
+--FILE--
+<?php
+
+$oProcessor = new \CSS3Processor();
+
+$sCSS = 'a{width:0\0;height:1\0;b:x\0041 y;c:a\0 b;d:"\00041"}';
+
+var_dump($oProcessor->dump($sCSS));
+var_dump($oProcessor->minify($sCSS));
+
+?>
+===DONE===
+--EXPECT--
+string(53) "a{width:0\0;height:1\0;b:x\0041 y;c:a�b;d:"\00041"}"
+string(48) "a{width:0\0;height:1\0;b:x\41 y;c:a�b;d:"\41"}"
+===DONE===
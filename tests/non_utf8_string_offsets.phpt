@@ -0,0 +1,59 @@
+--TEST--
+Test the detection of corrupt UTF-8 bytes at the block boundaries of the validator
+--FILE--
+<?php
+
+$aTests = [
+	'continuation byte at 15'			=> str_repeat('a', 15) . "\x80" . str_repeat('a', 16),
+	'continuation byte at 16'			=> str_repeat('a', 16) . "\x80" . str_repeat('a', 15),
+	'continuation byte at 31'			=> str_repeat('a', 31) . "\x80" . str_repeat('a', 8),
+	'continuation byte at 32'			=> str_repeat('a', 32) . "\x80" . str_repeat('a', 8),
+	'continuation byte at the end'		=> str_repeat('a', 32) . "\x80",
+	'stray continuation byte'			=> "a{content:\"\xC3\xA9\xA9\"}",
+	'truncated character at the end'	=> str_repeat('a', 40) . "\xE2\x82",
+	'truncated character'				=> str_repeat('a', 40) . "\xE2\x82a",
+	'truncated character only'			=> "\xE2\x82",
+	'valid characters at 15 and 30'		=> str_repeat('a', 15) . "\xC3\xA9" . str_repeat('a', 14) . "\xE2\x82\xAC" . str_repeat('a', 10),
+	'valid characters at 31 and 65'		=> str_repeat('a', 31) . "\xE2\x82\xAC" . str_repeat('a', 31) . "\xF0\x9F\x98\x80",
+];
+
+$oProcessor = new \CSS3Processor();
+
+foreach ($aTests as $sName => $sCSS) {
+	foreach (['dump', 'minify'] as $sMethod) {
+		try {
+			$sResult = $oProcessor->$sMethod($sCSS);
+
+			printf("%s, %s: %s\n", $sName, $sMethod, ($sResult === $sCSS) ? 'unchanged' : 'changed');
+		} catch (Exception $ex) {
+			printf("%s, %s: %s (%d)\n", $sName, $sMethod, $ex->getMessage(), $ex->getCode());
+		}
+	}
+}
+
+?>
+===DONE===
+--EXPECT--
+continuation byte at 15, dump: extcss3: Invalid or corrupt UTF-8 string detected (2)
+continuation byte at 15, minify: extcss3: Invalid or corrupt UTF-8 string detected (2)
+continuation byte at 16, dump: extcss3: Invalid or corrupt UTF-8 string detected (2)
+continuation byte at 16, minify: extcss3: Invalid or corrupt UTF-8 string detected (2)
+continuation byte at 31, dump: extcss3: Invalid or corrupt UTF-8 string detected (2)
+continuation byte at 31, minify: extcss3: Invalid or corrupt UTF-8 string detected (2)
+continuation byte at 32, dump: extcss3: Invalid or corrupt UTF-8 string detected (2)
+continuation byte at 32, minify: extcss3: Invalid or corrupt UTF-8 string detected (2)
+continuation byte at the end, dump: extcss3: Invalid or corrupt UTF-8 string detected (2)
+continuation byte at the end, minify: extcss3: Invalid or corrupt UTF-8 string detected (2)
+stray continuation byte, dump: extcss3: Invalid or corrupt UTF-8 string detected (2)
+stray continuation byte, minify: extcss3: Invalid or corrupt UTF-8 string detected (2)
+truncated character at the end, dump: extcss3: Invalid or corrupt UTF-8 string detected (2)
+truncated character at the end, minify: extcss3: Invalid or corrupt UTF-8 string detected (2)
+truncated character, dump: extcss3: Invalid or corrupt UTF-8 string detected (2)
+truncated character, minify: extcss3: Invalid or corrupt UTF-8 string detected (2)
+truncated character only, dump: extcss3: Invalid or corrupt UTF-8 string detected (2)
+truncated character only, minify: extcss3: Invalid or corrupt UTF-8 string detected (2)
+valid characters at 15 and 30, dump: unchanged
+valid characters at 15 and 30, minify: unchanged
+valid characters at 31 and 65, dump: unchanged
+valid characters at 31 and 65, minify: unchanged
+===DONE===
@@ -0,0 +1,82 @@
+--TEST--
+Test repeated CSS3Processor::minify() and ::dump() calls on the same object
+--FILE--
+<?php
+
+function process(\CSS3Processor $oProcessor, $sMethod, $sCSS, $aVendors)
+{
+	if ($sMethod === 'dump') {
+		return $oProcessor->dump($sCSS);
+	} else if ($aVendors === null) {
+		return $oProcessor->minify($sCSS);
+	}
+
+	return $oProcessor->minify($sCSS, $aVendors);
+}
+
+$cModifier = function (array $aData) {
+	return strtoupper($aData['value']);
+};
+
+$sSmall = 'a { color: #ff0000; -moz-border-radius: 1px; -webkit-border-radius: 1px; border-radius: 1px; background: url(img/a.png); }';
+$sLarge = str_repeat("/* comment */\n.c { -moz-box-shadow: 0 0 1px #000000; box-shadow: 0 0 1px #000000; margin: 0.50em; background: url('img/b.png'); }\n", 2000);
+
+$aSteps = [
+	['minify',	$sSmall,	null,					false],
+	['minify',	$sLarge,	['-moz'],				false],
+	['minify',	$sSmall,	['-moz'],				false],
+	['dump',	$sLarge,	null,					false],
+	['minify',	$sSmall,	['-webkit'],			false],
+	['minify',	$sSmall,	['-webkit'],			false],
+	['minify',	$sSmall,	['-moz', '-webkit'],	false],
+	['minify',	$sSmall,	null,					false],
+	['minify',	$sLarge,	['-moz'],				true],
+	['minify',	$sSmall,	['-moz'],				true],
+	['dump',	$sSmall,	null,					true],
+	['minify',	$sSmall,	null,					true],
+];
+
+$oProcessor = new \CSS3Processor();
+
+foreach ($aSteps as $i => list($sMethod, $sCSS, $aVendors, $bModifier)) {
+	$oFresh = new \CSS3Processor();
+
+	if ($bModifier) {
+		$oProcessor->setModifier(\CSS3Processor::TYPE_URL, $cModifier);
+		$oFresh->setModifier(\CSS3Processor::TYPE_URL, $cModifier);
+	}
+
+	$sResult = process($oProcessor, $sMethod, $sCSS, $aVendors);
+
+	printf("%d %s %d %s\n", $i, $sMethod, strlen($sResult), var_export($sResult === process($oFresh, $sMethod, $sCSS, $aVendors), true));
+
+	if ($sCSS === $sSmall) {
+		echo $sResult, "\n";
+	}
+}
+
+?>
+===DONE===
+--EXPECT--
+0 minify 105 true
+a{color:red;-moz-border-radius:1px;-webkit-border-radius:1px;border-radius:1px;background:url(img/a.png)}
+1 minify 134000 true
+2 minify 82 true
+a{color:red;-webkit-border-radius:1px;border-radius:1px;background:url(img/a.png)}
+3 dump 260000 true
+4 minify 79 true
+a{color:red;-moz-border-radius:1px;border-radius:1px;background:url(img/a.png)}
+5 minify 79 true
+a{color:red;-moz-border-radius:1px;border-radius:1px;background:url(img/a.png)}
+6 minify 56 true
+a{color:red;border-radius:1px;background:url(img/a.png)}
+7 minify 105 true
+a{color:red;-moz-border-radius:1px;-webkit-border-radius:1px;border-radius:1px;background:url(img/a.png)}
+8 minify 134000 true
+9 minify 82 true
+a{color:red;-webkit-border-radius:1px;border-radius:1px;background:url(IMG/A.PNG)}
+10 dump 122 true
+a { color: #ff0000; -moz-border-radius: 1px; -webkit-border-radius: 1px; border-radius: 1px; background: url(IMG/A.PNG); }
+11 minify 105 true
+a{color:red;-moz-border-radius:1px;-webkit-border-radius:1px;border-radius:1px;background:url(IMG/A.PNG)}
+===DONE===
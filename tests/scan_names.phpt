@@ -0,0 +1,79 @@
+--TEST--
+Test names around the block sizes of the scanners
+--FILE--
+<?php
+
+include __DIR__ . '/scan_blocks.inc';
+
+scan_blocks(function ($n) {
+	return [
+		'ident'						=> str_repeat('x', $n) . ':"x"',
+		'ident with dashes'			=> '-' . substr(str_repeat('a-b_', $n), 0, $n - 1) . ':"x"',
+		'hash'						=> '#' . str_repeat('x', $n) . ' "x"',
+		'dimension'					=> '1' . str_repeat('x', $n) . ' "x"',
+		'at-keyword'				=> '@' . str_repeat('x', $n) . ' "x";',
+		'function'					=> str_repeat('x', $n) . '("x")',
+		'function with dashes'		=> '-' . substr(str_repeat('a-b_', $n), 0, $n - 1) . '("x")',
+		'function with a character'	=> str_repeat('x', $n - 1) . 'éx("x")',
+		'function with an escape'	=> str_repeat('x', $n - 1) . '\\41 x("x")',
+	];
+});
+
+?>
+===DONE===
+--EXPECT--
+ident 15: string/3
+ident with dashes 15: string/3
+hash 15: string/3
+dimension 15: string/3
+at-keyword 15: string/3 in at_keyword/16
+function 15: string/3 in function/15
+function with dashes 15: string/3 in function/15
+function with a character 15: string/3 in function/17
+function with an escape 15: string/3 in function/19
+ident 16: string/3
+ident with dashes 16: string/3
+hash 16: string/3
+dimension 16: string/3
+at-keyword 16: string/3 in at_keyword/17
+function 16: string/3 in function/16
+function with dashes 16: string/3 in function/16
+function with a character 16: string/3 in function/18
+function with an escape 16: string/3 in function/20
+ident 17: string/3
+ident with dashes 17: string/3
+hash 17: string/3
+dimension 17: string/3
+at-keyword 17: string/3 in at_keyword/18
+function 17: string/3 in function/17
+function with dashes 17: string/3 in function/17
+function with a character 17: string/3 in function/19
+function with an escape 17: string/3 in function/21
+ident 31: string/3
+ident with dashes 31: string/3
+hash 31: string/3
+dimension 31: string/3
+at-keyword 31: string/3 in at_keyword/32
+function 31: string/3 in function/31
+function with dashes 31: string/3 in function/31
+function with a character 31: string/3 in function/33
+function with an escape 31: string/3 in function/35
+ident 32: string/3
+ident with dashes 32: string/3
+hash 32: string/3
+dimension 32: string/3
+at-keyword 32: string/3 in at_keyword/33
+function 32: string/3 in function/32
+function with dashes 32: string/3 in function/32
+function with a character 32: string/3 in function/34
+function with an escape 32: string/3 in function/36
+ident 33: string/3
+ident with dashes 33: string/3
+hash 33: string/3
+dimension 33: string/3
+at-keyword 33: string/3 in at_keyword/34
+function 33: string/3 in function/33
+function with dashes 33: string/3 in function/33
+function with a character 33: string/3 in function/35
+function with an escape 33: string/3 in function/37
+===DONE===
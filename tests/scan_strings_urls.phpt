@@ -0,0 +1,93 @@
+--TEST--
+Test string and url bodies around the block sizes of the scanners
+--FILE--
+<?php
+
+include __DIR__ . '/scan_blocks.inc';
+
+scan_blocks(function ($n) {
+	return [
+		'string'						=> '"' . str_repeat('x', $n) . '"',
+		'single quoted string'			=> "'" . str_repeat('x', $n) . "'",
+		'string with an escaped quote'	=> '"' . str_repeat('x', $n - 1) . '\\"x"',
+		'string with a character'		=> '"' . str_repeat('x', $n - 1) . 'éx"',
+		'bad string'					=> '"' . str_repeat('x', $n) . "\na",
+		'url'							=> 'url(' . str_repeat('x', $n) . ')',
+		'url with whitespace'			=> 'url(' . str_repeat('x', $n) . '  )',
+		'url with a character'			=> 'url(' . str_repeat('x', $n - 1) . 'éx)',
+		'bad url'						=> 'url(' . str_repeat('x', $n) . '"x)',
+	];
+});
+
+$oProcessor = new \CSS3Processor();
+$sBase64 = str_repeat('QUJD', 2000);
+
+$aTests = [
+	'data uri'			=> 'a{background:url(data:image/png;base64,' . $sBase64 . ')}',
+	'quoted data uri'	=> 'a{background:url("data:image/png;base64,' . $sBase64 . '")}',
+];
+
+foreach ($aTests as $sName => $sCSS) {
+	printf("%s: %s %s\n", $sName, scan_tokens($sCSS), var_export($oProcessor->minify($sCSS) === $sCSS, true));
+}
+
+?>
+===DONE===
+--EXPECT--
+string 15: string/17
+single quoted string 15: string/17
+string with an escaped quote 15: string/19
+string with a character 15: string/19
+bad string 15: bad_string/16
+url 15: url/15
+url with whitespace 15: url/15 (url(xxxxxxxxxxxxxxx))
+url with a character 15: url/17
+bad url 15: bad_url/18
+string 16: string/18
+single quoted string 16: string/18
+string with an escaped quote 16: string/20
+string with a character 16: string/20
+bad string 16: bad_string/17
+url 16: url/16
+url with whitespace 16: url/16 (url(xxxxxxxxxxxxxxxx))
+url with a character 16: url/18
+bad url 16: bad_url/19
+string 17: string/19
+single quoted string 17: string/19
+string with an escaped quote 17: string/21
+string with a character 17: string/21
+bad string 17: bad_string/18
+url 17: url/17
+url with whitespace 17: url/17 (url(xxxxxxxxxxxxxxxxx))
+url with a character 17: url/19
+bad url 17: bad_url/20
+string 31: string/33
+single quoted string 31: string/33
+string with an escaped quote 31: string/35
+string with a character 31: string/35
+bad string 31: bad_string/32
+url 31: url/31
+url with whitespace 31: url/31 (url(xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx))
+url with a character 31: url/33
+bad url 31: bad_url/34
+string 32: string/34
+single quoted string 32: string/34
+string with an escaped quote 32: string/36
+string with a character 32: string/36
+bad string 32: bad_string/33
+url 32: url/32
+url with whitespace 32: url/32 (url(xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx))
+url with a character 32: url/34
+bad url 32: bad_url/35
+string 33: string/35
+single quoted string 33: string/35
+string with an escaped quote 33: string/37
+string with a character 33: string/37
+bad string 33: bad_string/34
+url 33: url/33
+url with whitespace 33: url/33 (url(xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx))
+url with a character 33: url/35
+bad url 33: bad_url/36
+data uri: url/8022 in br_co/1 true
+quoted data uri: url/8024 in br_co/1 true
+===DONE===
@@ -0,0 +1,58 @@
+--TEST--
+Test whitespace runs and comments around the block sizes of the scanners
+--FILE--
+<?php
+
+include __DIR__ . '/scan_blocks.inc';
+
+scan_blocks(function ($n) {
+	return [
+		'whitespace'			=> 'a' . str_repeat(' ', $n) . '/**/',
+		'mixed whitespace'		=> 'a' . substr(str_repeat(" \t\n", $n), 0, $n) . '/**/',
+		'comment'				=> '/*' . str_repeat('x', $n) . '*/a',
+		'comment with a star'	=> '/*' . str_repeat('x', $n - 1) . '*x*/a',
+		'comment end'			=> '/*' . str_repeat('x', $n - 2) . '*/a',
+		'unclosed comment'		=> '/*' . str_repeat('x', $n),
+	];
+});
+
+?>
+===DONE===
+--EXPECT--
+whitespace 15: comment/4
+mixed whitespace 15: comment/4
+comment 15: comment/19
+comment with a star 15: comment/20
+comment end 15: comment/17
+unclosed comment 15: comment/17
+whitespace 16: comment/4
+mixed whitespace 16: comment/4
+comment 16: comment/20
+comment with a star 16: comment/21
+comment end 16: comment/18
+unclosed comment 16: comment/18
+whitespace 17: comment/4
+mixed whitespace 17: comment/4
+comment 17: comment/21
+comment with a star 17: comment/22
+comment end 17: comment/19
+unclosed comment 17: comment/19
+whitespace 31: comment/4
+mixed whitespace 31: comment/4
+comment 31: comment/35
+comment with a star 31: comment/36
+comment end 31: comment/33
+unclosed comment 31: comment/33
+whitespace 32: comment/4
+mixed whitespace 32: comment/4
+comment 32: comment/36
+comment with a star 32: comment/37
+comment end 32: comment/34
+unclosed comment 32: comment/34
+whitespace 33: comment/4
+mixed whitespace 33: comment/4
+comment 33: comment/37
+comment with a star 33: comment/38
+comment end 33: comment/35
+unclosed comment 33: comment/35
+===DONE===
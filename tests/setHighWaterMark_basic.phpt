@@ -0,0 +1,59 @@
+--TEST--
+Test CSS3Processor::setHighWaterMark() method
+--FILE--
+<?php
+
+$sSmall = 'a { color: #ff0000; margin: 0.50em; background: url(img/a.png); }';
+$sLarge = str_repeat(".c { box-shadow: 0 0 1px #000000; margin: 0.50em; content: 'x\\\\y'; }\n", 2000);
+
+$oFresh = new \CSS3Processor();
+
+$sSmallResult = $oFresh->minify($sSmall);
+$sLargeResult = $oFresh->minify($sLarge);
+
+foreach ([0, 1, 100, 4096, 1048576] as $iBytes) {
+	$oProcessor = new \CSS3Processor();
+
+	var_dump($oProcessor->setHighWaterMark($iBytes));
+
+	// The buffers are shrunk after every large input and grown again for the next one
+	for ($i = 0; $i < 3; $i++) {
+		var_dump(
+			($oProcessor->minify($sLarge) === $sLargeResult) &&
+			($oProcessor->minify($sSmall) === $sSmallResult) &&
+			($oProcessor->dump($sLarge) === $oFresh->dump($sLarge))
+		);
+	}
+}
+
+try {
+	var_dump($oProcessor->setHighWaterMark(-1));
+} catch (Exception $e) {
+	var_dump($e->getMessage());
+}
+
+?>
+===DONE===
+--EXPECT--
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+string(51) "extcss3: Invalid paramenter or parameter type given"
+===DONE===
@@ -0,0 +1,37 @@
+--TEST--
+Test the <string> token of an "@import" rule
+--FILE--
+<?php
+
+$oProcessor = new \CSS3Processor();
+
+// Only the <string> right after "@import" (ASCII case-insensitive, over whitespace and comments) is an import
+$sCSS = '@import /*c*/ "a.css";@IMPORT "b.css" screen;@import url(c.css);@import url("d.css") "e";@import;a{content:"f";background:url(g.png)}';
+
+$aTokens = $oProcessor->tokenize($sCSS);
+
+foreach ($aTokens['type'] as $i => $iType) {
+	if (in_array($iType, [CSS3Processor::TYPE_STRING, CSS3Processor::TYPE_URL], true)) {
+		printf(
+			"%s %d %s\n",
+			($iType === CSS3Processor::TYPE_URL) ? 'url' : 'string',
+			$aTokens['flag'][$i],
+			substr($aTokens['css'], $aTokens['offset'][$i], $aTokens['length'][$i])
+		);
+	}
+}
+
+var_dump($oProcessor->minify($sCSS));
+
+?>
+===DONE===
+--EXPECT--
+url 6 "a.css"
+url 6 "b.css"
+url 0 c.css
+url 5 "d.css"
+string 5 "e"
+string 5 "f"
+url 0 g.png
+string(123) "@import"a.css";@IMPORT"b.css"screen;@import url(c.css);@import url("d.css")"e";@import;a{content:"f";background:url(g.png)}"
+===DONE===
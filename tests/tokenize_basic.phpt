@@ -0,0 +1,97 @@
+--TEST--
+Test CSS3Processor::tokenize() method
+--FILE--
+<?php
+
+$oProcessor = new \CSS3Processor();
+
+// The modifiers are not called by ::tokenize()
+$oProcessor->setModifier(CSS3Processor::TYPE_COMMENT, function ($aData) { echo "called\n"; return ''; });
+
+var_dump($oProcessor->tokenize(''));
+
+function printTokens(array $aTokens)
+{
+	foreach ($aTokens['type'] as $i => $iType) {
+		printf(
+			"%d %d %d %d %s\n",
+			$iType,
+			$aTokens['offset'][$i],
+			$aTokens['length'][$i],
+			$aTokens['flag'][$i],
+			addcslashes(substr($aTokens['css'], $aTokens['offset'][$i], $aTokens['length'][$i]), "\n")
+		);
+	}
+}
+
+$aTokens = $oProcessor->tokenize("a { width: 1.5em; }\r\n/* x */ @import url(\"b.css\");");
+
+var_dump($aTokens['css']);
+printTokens($aTokens);
+
+// The offsets refer to the preprocessed string, not to the given one
+$sCSS = "a\\30 b\0c{d:\"e\\\r\nf\";\f}\r\n.x\\0 y\r\n";
+$aTokens = $oProcessor->tokenize($sCSS);
+
+var_dump(strlen($sCSS));
+var_dump($aTokens['css']);
+printTokens($aTokens);
+
+?>
+===DONE===
+--EXPECT--
+array(5) {
+  ["css"]=>
+  string(0) ""
+  ["type"]=>
+  array(0) {
+  }
+  ["offset"]=>
+  array(0) {
+  }
+  ["length"]=>
+  array(0) {
+  }
+  ["flag"]=>
+  array(0) {
+  }
+}
+string(49) "a { width: 1.5em; }
+/* x */ @import url("b.css");"
+1 0 1 0 a
+20 1 1 0  
+30 2 1 0 {
+20 3 1 0  
+1 4 5 0 width
+23 9 1 0 :
+20 10 1 0  
+12 11 5 4 1.5em
+24 16 1 0 ;
+20 17 1 0  
+31 18 1 0 }
+20 19 1 0 \n
+32 20 7 0 /* x */
+20 27 1 0  
+3 28 7 0 @import
+20 35 1 0  
+7 40 7 5 "b.css"
+24 48 1 0 ;
+int(31)
+string(30) "a\30 b�c{d:"e\
+f";
+}
+.x�y
+"
+1 0 10 0 a\30 b�c
+30 10 1 0 {
+1 11 1 0 d
+23 12 1 0 :
+5 13 6 5 "e\\nf"
+24 19 1 0 ;
+20 20 1 0 \n
+31 21 1 0 }
+20 22 1 0 \n
+9 23 1 0 .
+1 24 5 0 x�y
+20 29 1 0 \n
+===DONE===
@@ -0,0 +1,43 @@
+--TEST--
+Test that the zero-copy and the preprocessed copy of a CSS string give the same results
+--FILE--
+<?php
+
+function stylesheet($sName, $sEOL, $sComment)
+{
+	$sCSS = "/* %s */\n.%s > li:hover, .%s-item {\n\tcolor: #ffffff;\n\tmargin: 0.50em 0px;\n\tcontent: \"%s\";\n\tbackground: url(img/%s.png);\n}\n@media screen {\n\t.%s { padding: 010px }\n}\n";
+
+	return str_replace("\n", $sEOL, sprintf($sCSS, $sComment, $sName, $sName, $sName, $sName, $sName));
+}
+
+$oProcessor = new \CSS3Processor();
+
+// Without "\r", "\f", "\0" and "\\" the original string is tokenized in place
+$sAscii			= stylesheet('nav', "\n", 'navigation');
+$sAsciiCRLF		= stylesheet('nav', "\r\n", 'navigation');
+$sAsciiEscape	= stylesheet('nav', "\n", 'navigation \\ escaped');
+$sUTF8			= stylesheet('navé', "\n", 'navigation');
+$sUTF8CRLF		= stylesheet('navé', "\r\n", 'navigation');
+
+var_dump($oProcessor->minify($sAscii));
+var_dump($oProcessor->minify($sAscii) === $oProcessor->minify($sAsciiCRLF));
+var_dump($oProcessor->minify($sAscii) === $oProcessor->minify($sAsciiEscape));
+var_dump($oProcessor->dump($sAscii) === $oProcessor->dump($sAsciiCRLF));
+
+var_dump($oProcessor->minify($sUTF8));
+var_dump($oProcessor->minify($sUTF8) === $oProcessor->minify($sUTF8CRLF));
+var_dump($oProcessor->dump($sUTF8) === $oProcessor->dump($sUTF8CRLF));
+var_dump($oProcessor->dump($sUTF8) === $sUTF8);
+
+?>
+===DONE===
+--EXPECT--
+string(124) ".nav>li:hover,.nav-item{color:#fff;margin:.5em 0;content:"nav";background:url(img/nav.png)}@media screen{.nav{padding:10px}}"
+bool(true)
+bool(true)
+bool(true)
+string(134) ".navé>li:hover,.navé-item{color:#fff;margin:.5em 0;content:"navé";background:url(img/navé.png)}@media screen{.navé{padding:10px}}"
+bool(true)
+bool(true)
+bool(true)
+===DONE===